@@ -6,4 +6,10 @@
 // The command line buffer size
 #define CMD_LINE_SIZE     40
 
+// Enables the main loop profiler and the Monitor command profile
+//#define PROFILE_LOOP
+
+// A 32 bit SABA::Timing::ticker, for delays longer than 65535 ticks
+//#define TICKER_32BIT
+
 #endif /* DEVICE_H_ */
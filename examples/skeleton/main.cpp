@@ -5,7 +5,7 @@
 SABA::Timer1 timer1;
 
 // Led flashing delay 
-SABA::Timing::SingleDelayFixed<uint8_t,50> ledDelay;
+SABA::Timing::ScheduledDelay ledDelay;
 
 void initializeApplication()
 {
@@ -18,7 +18,7 @@ void initializeApplication()
     .icr= 625;
 
   sei();
-  ledDelay.start();
+  ledDelay.start(50);
 
   out << PSTR("ALT") << SABA::endl;
 }
@@ -29,7 +29,7 @@ void cyclic()
   {
     LED led;
     led.toggle();
-    ledDelay.start();
+    ledDelay.start(50);
   }
 }
 
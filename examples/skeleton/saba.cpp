@@ -1,7 +1,17 @@
 #include "saba.h"
 
-// the Usart driver, using 57600 Baud
-SABA::USART0 usart(57600);
+// the interrupt driven Usart driver, using 57600 Baud, 32 byte receive and 64 byte transmit buffer
+SABA::BufferedUsart<SABA::USART0,32,64> usart(57600);
+
+ISR(USART_RX_vect)
+{
+  usart.receiveInterrupt();
+}
+
+ISR(USART_UDRE_vect)
+{
+  usart.dataRegisterEmptyInterrupt();
+}
 
 // the OStream putch method redirects output to the Usart
 void putch(uint8_t c)
@@ -13,18 +23,67 @@ void putch(uint8_t c)
 // It will use Usart for output
 SABA::OStream <&putch> out;
 
-// The command line will use out as input. It will be filled within the main loop
-SABA::CmdLine<uint8_t,CMD_LINE_SIZE,&putch,SABA::OStream,execute> cmdline;
-
 // The Debug Monitor defines a few commands accessible by serial port
 typedef SABA::Monitor<uint8_t,CMD_LINE_SIZE,SABA::OStream,&putch> DebugMonitor;
 
+const char helpAdc[] PROGMEM = "show the ADC registers";
+const char helpBlock[] PROGMEM = "d|f address count [h]  stream memory raw or as hex";
+const char helpClock[] PROGMEM = "show OSCCAL and CLKPR";
+const char helpEeprom[] PROGMEM = "start rows  dump the EEPROM";
+const char helpFifos[] PROGMEM = "show the Fifo statistics";
+const char helpPeek[] PROGMEM = "d|f address [count]  dump data space or FLASH";
+const char helpPoke[] PROGMEM = "address value [value ...]  write the data space";
+#ifdef PROFILE_LOOP
+// Timer1 counts 0 - 625 per tick, see initializeApplication
+typedef SABA::LoopProfiler<SABA::Timing::Timer1Counter,626,100> Profiler;
+
+const char helpProfile[] PROGMEM = "[r]  show or reset the main loop timing";
+#endif
+const char helpPorts[] PROGMEM = "port [s|t|r|= bit/value] show or change a port";
+const char helpSpi[] PROGMEM = "show the SPI registers";
+const char helpTimer[] PROGMEM = "[0|1|2] show the timer registers";
+const char helpWatch[] PROGMEM = "+ address [1|2], - [address], p ticks  print changed values";
+
+// The command table, sorted by name. help lists the commands, true marks the commands answering binary frames.
+constexpr SABA::Command<uint8_t,CMD_LINE_SIZE> commands[] PROGMEM =
+{
+  { "adc", &DebugMonitor::adc, helpAdc, true },
+  { "block", &DebugMonitor::block, helpBlock, false },
+  { "clock", &DebugMonitor::clock, helpClock, true },
+  { "eeprom", &DebugMonitor::eeprom, helpEeprom, false },
+  { "fifos", &DebugMonitor::fifos, helpFifos, false },
+  { "peek", &DebugMonitor::peek, helpPeek, true },
+  { "poke", &DebugMonitor::poke, helpPoke, true },
+  { "ports", &DebugMonitor::ports, helpPorts, true },
+#ifdef PROFILE_LOOP
+  { "profile", &DebugMonitor::profile<Profiler>, helpProfile, true },
+#endif
+  { "spi", &DebugMonitor::spi, helpSpi, true },
+  { "timer", &DebugMonitor::timer, helpTimer, false },
+  { "watch", &DebugMonitor::watch, helpWatch, false }
+};
+static_assert(SABA::commandsSorted(commands), "commands must be sorted by name");
+
+// The command line will use out as input. It will be filled within the main loop
+SABA::CmdLine<uint8_t,CMD_LINE_SIZE,&putch,SABA::OStream,execute> cmdline(commands);
+
 // The system wide ticker, has to be incremented periodically
+#ifdef TICKER_32BIT
+volatile uint32_t SABA::Timing::ticker;
+#else
 volatile uint16_t SABA::Timing::ticker;
+#endif
+
+// The timer service of the Scheduled delays, called from the main loop
+SABA::Timing::Scheduler SABA::Timing::scheduler;
 
 ISR(TIMER1_OVF_vect, ISR_NAKED)
 {
+#ifdef TICKER_32BIT
+  ISR_INCREMENTUINT32(SABA::Timing::ticker);
+#else
   ISR_INCREMENTUINT16(SABA::Timing::ticker);
+#endif
 
   //++SABA::Timing::ticker;
   /*asm volatile
@@ -48,20 +107,10 @@ ISR(TIMER1_OVF_vect, ISR_NAKED)
   );*/
 }
 
+// called for lines not starting with a name of the command table
 bool execute(char c)
 {
-  switch(c)
-  {
-    case 'A':
-      return DebugMonitor::adc(cmdline);
-    case 'P':
-      return DebugMonitor::ports(cmdline);
-    case 'S':
-      return DebugMonitor::spi(cmdline);
-
-    default:
-      return applicationCommand(c);
-  }
+  return applicationCommand(c);
 }
 
 int main(void)
@@ -71,8 +120,13 @@ int main(void)
 
   for(;;)
   {
-    if(usart.receiverComplete())
-      cmdline.appendChar(usart.getch());
+    SABA_PROFILE(Profiler);
+
+    while(usart.available())
+      cmdline.appendChar(usart.read());
+
+    DebugMonitor::watchPoll();
+    SABA::Timing::scheduler.cyclic();
 
     cyclic();
   }
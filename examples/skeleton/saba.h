@@ -14,6 +14,7 @@
 #include <saba_monitor.h>
 #include <saba_timer.h>
 #include <saba_timing.h>
+#include <saba_profiler.h>
 
 // the global putch method used to redirect the out
 extern void putch(uint8_t c);
@@ -0,0 +1,151 @@
+/*
+ * saba_clock.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Sub tick timestamps, combining SABA::Timing::ticker with the counter of the ticker timer
+ */
+
+#ifndef SABA_CLOCK_H_
+#define SABA_CLOCK_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include <saba_avr.h>
+#include <saba_timer.h>
+#include <saba_timing.h>
+
+namespace SABA
+{
+  namespace Timing
+  {
+#ifdef TIMSK1
+    //! the Timer1 counter and overflow flag read by Clock
+    struct Timer1Counter
+    {
+      static uint16_t count()
+      {
+        return TCNT1;
+      }
+
+      static bool overflowPending()
+      {
+        return (TIFR1 & BIT(TOV1)) != 0;
+      }
+    };
+#endif
+
+    //! the greatest common divisor, used for the constexpr scaling of Clock
+    constexpr uint32_t gcd(uint32_t a, uint32_t b)
+    {
+      return b == 0 ? a : gcd(b, a % b);
+    }
+
+    // \brief Timestamps with the resolution of the ticker timer
+    /**
+    The timer overflow interrupt increments Timing::ticker, the timestamp is the ticker multiplied by the counts per
+    tick plus the counter value, read with interrupts disabled. An overflow, which is pending, but not yet counted by
+    the interrupt, is added, if the counter is in the lower half of its period: then it wrapped before it was read.
+    In the fast PWM modes the overflow flag is set at TOP, TOP is counted as the first count of the next tick.
+    The timestamps wrap around with the ticker, elapsed() corrects it for a 16 bit ticker. micros() and cycles() are
+    meant for short durations, toMicros(elapsed(start)) for longer ones.
+    @tparam COUNTER the counter and overflow flag, e.g. Timer1Counter
+    @tparam CLOCK_SELECT the timer prescaler
+    @tparam MODE Normal or one of the fast PWM modes
+    @tparam TOP the TOP value of the mode, e.g. ICR1, 0xffff for Normal
+
+    Usage:
+    ~~~{.c}
+    // Timer1 in FAST_PWM_ICR1 mode with ICR1 625, see the skeleton
+    typedef SABA::Timing::Clock<SABA::Timing::Timer1Counter,SABA::Timer16::By256,SABA::Timer16::FAST_PWM_ICR1,625> Clock;
+
+    uint32_t start= Clock::counts();
+    ...
+    out << Clock::toMicros(Clock::elapsed(start)) << PSTR(" us") << SABA::endl;
+    ~~~
+    */
+    template<class COUNTER, Timer16::ClockSelect CLOCK_SELECT, Timer16::WaveformGenerationMode MODE, uint16_t TOP>
+    class Clock
+    {
+      public:
+
+      static constexpr uint16_t PRESCALER = Timer16::prescaler(CLOCK_SELECT);
+      static constexpr uint32_t PERIOD = uint32_t(TOP) + 1; //!< the counts per tick
+      static constexpr bool OVERFLOW_AT_TOP = MODE != Timer16::Normal;
+
+      static_assert(PRESCALER != 0, "a prescaled clkIO is needed");
+      static_assert(MODE == Timer16::Normal || MODE == Timer16::FAST_PWM8 || MODE == Timer16::FAST_PWM9 || MODE == Timer16::FAST_PWM10
+        || MODE == Timer16::FAST_PWM_ICR1 || MODE == Timer16::FAST_PWM_OCR1A, "only Normal and the fast PWM modes count up to TOP");
+      static_assert(MODE != Timer16::Normal || TOP == 0xffff, "the TOP of Normal mode is 0xffff");
+
+#ifdef TICKER_32BIT
+      static constexpr uint32_t WRAP = 0; //!< the counts of a complete ticker period, 0 for 2^32
+#else
+      static constexpr uint32_t WRAP = uint32_t(uint64_t(0x10000) * PERIOD);
+#endif
+
+      static uint32_t counts() //! the timestamp in timer counts, may be called from an ISR
+      {
+        uint8_t sreg= SREG;
+        cli();
+
+        uint32_t ticks= ticker;
+        uint16_t count= COUNTER::count();
+        bool pending= COUNTER::overflowPending();
+
+        SREG= sreg;
+
+        if( OVERFLOW_AT_TOP )
+          count= count >= TOP ? 0 : count + 1;
+
+        // the counter wrapped before it was read, the overflow is not counted yet
+        if( pending && count < PERIOD / 2 )
+          ++ticks;
+
+        return ticks * PERIOD + count;
+      }
+
+      static uint32_t elapsed(uint32_t start) //! the counts since the timestamp start, up to one ticker period
+      {
+        uint32_t now= counts();
+
+        return now >= start ? now - start : now - start + WRAP;
+      }
+
+      static uint32_t cycles() //! the timestamp in CPU cycles
+      {
+        return toCycles(counts());
+      }
+
+      static constexpr uint32_t toCycles(uint32_t counts) //! converts timer counts to CPU cycles
+      {
+        return counts * PRESCALER;
+      }
+
+#ifdef F_CPU
+      static constexpr uint32_t MICROS_GCD = gcd(PRESCALER * 1000000UL, F_CPU);
+      static constexpr uint32_t MICROS_NUMERATOR = PRESCALER * 1000000UL / MICROS_GCD;
+      static constexpr uint32_t MICROS_DENOMINATOR = F_CPU / MICROS_GCD;
+
+      static uint32_t micros() //! the timestamp in microseconds
+      {
+        return toMicros(counts());
+      }
+
+      static constexpr uint32_t toMicros(uint32_t counts) //! converts timer counts to microseconds, rounded down
+      {
+        return MICROS_DENOMINATOR == 1 ? counts * MICROS_NUMERATOR :
+          MICROS_NUMERATOR == 1 ? counts / MICROS_DENOMINATOR :
+          uint32_t(uint64_t(counts) * MICROS_NUMERATOR / MICROS_DENOMINATOR);
+      }
+#endif
+    };
+  }
+}
+
+#endif // SABA_CLOCK_H_
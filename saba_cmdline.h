@@ -13,15 +13,223 @@
  #define SABA_CMDLINE_H_
 
  #include <saba_ostream.h>
+ #include <saba_frame.h>
 
 namespace SABA
 {
   //! the execute function is called if the user send the line
   typedef bool EXECUTE(char c);
 
+  //! the unsigned integer type of a size in bytes
+  template<uint8_t SIZE> struct UnsignedOf;
+  template<> struct UnsignedOf<1> { typedef uint8_t type; };
+  template<> struct UnsignedOf<2> { typedef uint16_t type; };
+  template<> struct UnsignedOf<4> { typedef uint32_t type; };
+  template<> struct UnsignedOf<8> { typedef uint64_t type; };
+
+  //! the value range of an integer type, used for the overflow checks, e.g. char, int or int16_t
+  template<typename T> struct IntLimits
+  {
+    typedef typename UnsignedOf<sizeof(T)>::type U;
+    static constexpr bool isSigned = T(-1) < T(0);
+    static constexpr U max = isSigned ? U(U(~U(0)) >> 1) : U(~U(0));
+  };
+
+  //! the value of a hexadecimal digit, 0xff if ch is no hexadecimal digit
+  inline uint8_t hexDigit( char ch )
+  {
+    if( ch < '0' )
+    {
+      return 0xff;
+    }
+    else if( ch <= '9' )
+    {
+      return ch -'0';
+    }
+    else if( ch < 'A' )
+    {
+      return 0xff;
+    }
+    else if( ch <= 'F' )
+    {
+      return 10+ ch - 'A';
+    }
+    else if( ch < 'a' )
+    {
+      return 0xff;
+    }
+    else if( ch <= 'f' )
+    {
+      return 10+ ch - 'a';
+    }
+    else
+    {
+      return 0xff;
+    }
+  }
+
+  //! the value of a decimal digit, 0xff if ch is no decimal digit
+  inline uint8_t decDigit( char ch )
+  {
+    if( ch < '0' || ch > '9' )
+      return 0xff;
+
+    return ch - '0';
+  }
+
+  // \brief An argument of the command line
+  /** 
+  Points into the line buffer, the text is not 0 terminated. The quotes of a quoted argument are not part of the text.
+  */
+  struct CmdArg
+  {
+    const char *text;   //!< the first character
+    uint8_t length;     //!< the number of characters
+    bool quoted;        //!< true, if the argument was enclosed in quotes
+
+    //! converts a decimal number with optional '-' or a hexadecimal number with 0x prefix. Returns false, if the text is no number or does not fit into T.
+    template<typename T> bool toInteger(T& value) const
+    {
+      typedef typename IntLimits<T>::U U;
+
+      uint8_t i= 0;
+      bool negative= IntLimits<T>::isSigned && length != 0 && text[0] == '-';
+      if( negative )
+        i= 1;
+
+      bool hex= length - i > 2 && text[i] == '0' && (text[i + 1] == 'x' || text[i + 1] == 'X');
+      if( hex )
+        i += 2;
+
+      if( quoted || i >= length )
+        return false;
+
+      // the magnitude of the most negative value is max + 1
+      const U limit= negative ? U(IntLimits<T>::max + 1) : IntLimits<T>::max;
+      const U limit10= negative ? U(IntLimits<T>::max + 1) / 10 : IntLimits<T>::max / 10;
+      const uint8_t limitDigit= negative ? U(IntLimits<T>::max + 1) % 10 : IntLimits<T>::max % 10;
+
+      U result= 0;
+      for(;i < length;i++)
+      {
+        uint8_t digit= hex ? hexDigit(text[i]) : decDigit(text[i]);
+        if( digit == 0xff )
+          return false;
+
+        if( hex )
+        {
+          if( result > (limit >> 4) )
+            return false;
+          result= U(result << 4) | digit;
+          if( result > limit )
+            return false;
+        }
+        else
+        {
+          if( result > limit10 || (result == limit10 && digit > limitDigit) )
+            return false;
+          result= U(result * 10 + digit);
+        }
+      }
+
+      value= negative ? T(U(0) - result) : T(result);
+
+      return true;
+    }
+
+    //! like toInteger, additionally checks the range min .. max
+    template<typename T> bool toInteger(T& value, T min, T max) const
+    {
+      T v;
+      if( !toInteger(v) || v < min || v > max )
+        return false;
+
+      value= v;
+
+      return true;
+    }
+
+    bool equals(const char *name) const //! true, if the text is equal to the 0 terminated name stored in FLASH, use PSTR("xxx")
+    {
+      for(uint8_t i=0;i < length;i++)
+      {
+        if( text[i] != char(pgm_read_byte(name + i)) )
+          return false;
+      }
+
+      return pgm_read_byte(name + length) == 0;
+    }
+  };
+
+  // \brief The arguments of a command line
+  /** 
+  Filled in one pass by CmdReader::tokenize(). The arguments are separated by blanks or TABs, a quoted argument may
+  contain blanks.
+  @tparam MAX_ARGS the max number of arguments
+  
+  Usage:
+  ~~~{.c}
+  static bool commandSet(SABA::CmdReader<uint8_t,CMD_LINE_SIZE>& cmdReader)
+  {
+    SABA::CmdArgs<2> args;
+    uint16_t address;
+    int8_t offset;
+
+    return cmdReader.tokenize(args) && args.count() == 2 && args[0].toInteger(address)
+      && args[1].toInteger(offset, int8_t(-10), int8_t(10));
+  }
+  ~~~ 
+  */
+  template<uint8_t MAX_ARGS>
+  class CmdArgs
+  {
+    public:
+
+    uint8_t count() const //! the number of arguments
+    {
+      return argc;
+    }
+
+    const CmdArg& operator [] (uint8_t i) const //! argument i, i must be < count()
+    {
+      return argv[i];
+    }
+
+    bool add(const char *text, uint8_t length, bool quoted) //! used by the tokenizer, returns false if there are too many arguments
+    {
+      if( argc >= MAX_ARGS )
+        return false;
+
+      argv[argc].text= text;
+      argv[argc].length= length;
+      argv[argc].quoted= quoted;
+      ++argc;
+
+      return true;
+    }
+
+    private:
+
+    CmdArg argv[MAX_ARGS];
+    uint8_t argc = 0;
+  };
+
+  //! the number of result bytes of a binary mode response
+  static constexpr uint8_t CMD_RESULT_SIZE = 16;
+
+  //! the status byte of a binary mode response
+  enum CmdStatus
+  {
+    CmdOk,          //!< the handler returned true
+    CmdFailed,      //!< the handler returned false
+    CmdUnknown      //!< the command index is not in the table or the command does not support binary mode
+  };
+
   // \brief A command line buffer reader super class
   /** 
   A derived class has to fill the buffer. This class provides methods to read characters, hex numbers or decimal numbers.
+  In binary mode the buffer contains the raw arguments, nextHex and nextDec read sizeof(T) bytes, low byte first,
+  and result() collects the response.
 
   @tparam INDEX_TYPE the index type, if the buffer size is < 256 use uint8_t, if >= 256 use uint16_t
   @tparam BUFFER_SIZE the size of the buffer. Max number of chars in one line.
@@ -32,6 +240,15 @@ namespace SABA
     public:
     char nextChar() //! return the next character of the buffer. If no more character is available, return 0
     {
+      if( binaryMode )
+      {
+        if( indexOut < binaryLength )
+          return char(binaryData[ indexOut++ ]);
+
+        error= 1;
+        return 0;
+      }
+
       char ch= 0;
       if( indexOut < BUFFER_SIZE )
       {
@@ -47,7 +264,7 @@ namespace SABA
     {
       char ch= nextChar();
       
-      while( ch == ' ' || ch == 9 )
+      while( !binaryMode && (ch == ' ' || ch == 9) )
         ch= nextChar();
       
       return ch;
@@ -55,10 +272,13 @@ namespace SABA
 
     template<typename T> T nextHex() //! interpret the next characters as a hexadecimal number. If there is no hexadecimal character or the input is bigger than the variable, the error flag is set.
     {
+      if( binaryMode )
+        return nextBinary<T>();
+
       T result= 0;
       
       uint8_t ch= fromHex( nextCharIgnoreBlank() );
-      if( ch == (char)0xff )
+      if( ch == 0xff )
       {
         error = 1;
         return 0;
@@ -66,7 +286,8 @@ namespace SABA
       
       do
       {
-        if( result & (0xf << ((uint8_t)(8*sizeof(T))-4)))
+        typedef typename IntLimits<T>::U U;
+        if( U(result) > (IntLimits<T>::max >> 4) )
         {
           error=1;
           return 0;
@@ -76,22 +297,25 @@ namespace SABA
         result |= ch;
         
         ch= fromHex( lineBuffer[indexOut] );
-        if( ch != (char)0xff )
+        if( ch != 0xff )
         {
           nextChar();
         }
       }
-      while( ch != (char)0xff );
+      while( ch != 0xff );
       
       return result;
     }
 
     template<typename T> T nextDec() //! interpret the next characters as a decimal number. If there is no decimal character or the input is bigger than the variable, the error flag is set.
     {
+      if( binaryMode )
+        return nextBinary<T>();
+
       T result= 0;
           
       uint8_t ch= fromDec( nextCharIgnoreBlank() );
-      if( ch == (char)0xff )
+      if( ch == 0xff )
       {
         error = 1;
         return 0;
@@ -99,32 +323,103 @@ namespace SABA
           
       do
       {
-        if( result  > (sizeof(T) == 1 ? 25 : (sizeof(T) == 2 ? 6553 : 429496729)))
+        typedef typename IntLimits<T>::U U;
+        if( U(result) > IntLimits<T>::max / 10 || (U(result) == IntLimits<T>::max / 10 && ch > IntLimits<T>::max % 10) )
         {
           error=1;
           return 0;
         }
             
-        result *= 10;
-        if( result + ch < result)
-        {
-          error=1;
-          return 0;
-        }
-
-        result += ch;
+        result= result * 10 + ch;
             
         ch= fromDec( lineBuffer[indexOut] );
-        if( ch != (char)0xff )
+        if( ch != 0xff )
         {
           nextChar();
         }
       }
-      while( ch != (char)0xff );
+      while( ch != 0xff );
           
       return result;
     }
 
+    const char *nextWord(INDEX_TYPE& length) //! return the next word, ending with a blank, TAB or the line end. The word is not 0 terminated, length receives the number of characters.
+    {
+      char ch= nextCharIgnoreBlank();
+      const char *word= lineBuffer + indexOut - (ch != 0 ? 1 : 0);
+
+      length= 0;
+      while( ch != 0 && ch != ' ' && ch != 9 )
+      {
+        ++length;
+        ch= nextChar();
+      }
+
+      return word;
+    }
+
+    template<uint8_t MAX_ARGS> bool tokenize(CmdArgs<MAX_ARGS>& args) //! split the rest of the line into arguments in one pass. Returns false, if there are too many arguments, a quote is not closed or in binary mode.
+    {
+      if( binaryMode )
+        return false;
+
+      const char *p= lineBuffer + indexOut;
+
+      for(;;)
+      {
+        while( *p == ' ' || *p == 9 )
+          ++p;
+
+        if( *p == 0 )
+          break;
+
+        bool quoted= *p == '"';
+        const char *start= quoted ? ++p : p;
+
+        if( quoted )
+        {
+          while( *p != 0 && *p != '"' )
+            ++p;
+          if( *p == 0 )
+            return false;
+        }
+        else
+        {
+          while( *p != 0 && *p != ' ' && *p != 9 )
+            ++p;
+        }
+
+        if( !args.add(start, uint8_t(p - start), quoted) )
+          return false;
+
+        if( quoted )
+          ++p;
+      }
+
+      indexOut= INDEX_TYPE(p - lineBuffer);
+
+      return true;
+    }
+
+    bool binary() //! true, if the command was received in binary mode. The handler should use result() instead of printing.
+    {
+      return binaryMode;
+    }
+
+    template<typename T> void result(T value) //! add a value to the binary mode response, low byte first. Ignored in text mode. More than CMD_RESULT_SIZE bytes answer CmdFailed.
+    {
+      if( !binaryMode )
+        return;
+
+      for(uint8_t i=0;i < sizeof(T);i++)
+      {
+        if( resultLength < CMD_RESULT_SIZE )
+          response[2 + resultLength++]= uint8_t(uint32_t(value) >> (i * 8));
+        else
+          resultLength= RESULT_OVERFLOW;
+      }
+    }
+
     bool operator () () //! return true, if there was no error in nextHex or nextDec function.
     {
       return !error;
@@ -134,76 +429,147 @@ namespace SABA
 
     uint8_t fromHex( char ch )
     {
-      if( ch < '0' )
-      {
-        return 0xff;
-      }
-      else if( ch <= '9' )
-      {
-        return ch -'0';
-      }
-      else if( ch < 'A' )
-      {
-        return 0xff;
-      }
-      else if( ch <= 'F' )
-      {
-        return 10+ ch - 'A';
-      }
-      else if( ch < 'a' )
-      {
-        return 0xff;
-      }
-      else if( ch <= 'f' )
-      {
-        return 10+ ch - 'a';
-      }
-      else
-      {
-        return 0xff;
-      }
+      return hexDigit(ch);
     }
 
     uint8_t fromDec( char ch )
     {
-      if( ch < '0' )
-      {
-        return 0xff;
-      }
-      else if( ch <= '9' )
-      {
-        return ch -'0';
-      }
-      else
-      {
-        return 0xff;
-      }
+      return decDigit(ch);
+    }
+
+    static constexpr uint8_t RESULT_OVERFLOW = 0xff;
+
+    template<typename T> T nextBinary()
+    {
+      uint32_t value= 0;
+      for(uint8_t i=0;i < sizeof(T);i++)
+        value |= uint32_t(uint8_t(nextChar())) << (i * 8);
+
+      return T(value);
     }
 
     char lineBuffer[BUFFER_SIZE];
     INDEX_TYPE indexOut = 0;
     bool error;
+    bool binaryMode = false;
+    const uint8_t *binaryData = nullptr;
+    INDEX_TYPE binaryLength = 0;
+    uint8_t response[2 + CMD_RESULT_SIZE];  // the command index, the CmdStatus and the result() bytes
+    uint8_t resultLength = 0;
+  };
+
+  //! the size of a Command name including the terminating 0
+  static constexpr uint8_t COMMAND_NAME_SIZE = 8;
+
+  // \brief An entry of a CmdLine command table
+  /** 
+  The table is stored in FLASH and must be sorted by name, check it with commandsSorted().
+
+  @tparam INDEX_TYPE the index type of the CmdLine
+  @tparam BUFFER_SIZE the buffer size of the CmdLine
+  */
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE>
+  struct Command
+  {
+    //! the command function, reads the arguments from the CmdReader. If it returns false an error message is printed.
+    typedef bool (*HANDLER)(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader);
+
+    char name[COMMAND_NAME_SIZE]; //!< the command name
+    HANDLER handler;              //!< the command function
+    const char *help;             //!< the help text stored in FLASH, may be nullptr
+    bool binary;                  //!< true, if the handler uses result() in binary mode instead of printing
   };
 
+  //! compares two 0 terminated names like strcmp
+  constexpr int8_t compareNames(const char *a, const char *b)
+  {
+    return (*a != *b || *a == 0) ? (*a < *b ? -1 : (*a > *b ? 1 : 0)) : compareNames(a + 1, b + 1);
+  }
+
+  //! true, if the command table is sorted by name without duplicates, used in a static_assert
+  template<class COMMAND, uint8_t COUNT> constexpr bool commandsSorted(const COMMAND (&table)[COUNT], uint8_t i = 1)
+  {
+    return i >= COUNT || (compareNames(table[i - 1].name, table[i].name) < 0 && commandsSorted(table, i + 1));
+  }
+
   // \brief A command line buffer, typically used as serial input buffer
   /** 
   The user input from (typically) serial port is collected in a line. Backspace will delete the last character.
   Enter will send the line to the EXECUTE function.
+  If a command table is passed to the constructor, the first word of the line is searched in the table by a binary search
+  and the handler is called. The command help prints the table. Lines without a matching name are passed to the
+  EXECUTE function.
+
+  The escape sequence ESC STX (0x1b 0x02) switches to binary mode for a machine interface, there is no echo.
+  The requests and responses are FrameTransport frames, COBS encoded with CRC16 and terminated by a 0 byte, so the
+  receiver synchronizes again after a lost byte. A damaged request is dropped without response.
+  The request payload is the index of the command in the table followed by the raw arguments. The response payload is
+  the command index, a CmdStatus and the result() bytes. Only commands marked binary in the table are called, the
+  others answer CmdUnknown. A request with an empty payload switches back to text mode.
+  The frame buffer needs BUFFER_SIZE + 2 bytes of RAM, max 254.
   
   @tparam INDEX_TYPE the index type, if the buffer size is < 256 use uint8_t, if >= 256 use uint16_t
   @tparam BUFFER_SIZE the size of the buffer. Max number of chars in one line.
   @tparam PUTCH The putch function receiving the output
   @tparam EXECUTE The execute function called after Enter has been received. If function returns false an error message is printed.
+
+  Usage:
+  ~~~{.c}
+  const char helpAdc[] PROGMEM = "read the ADC";
+
+  constexpr SABA::Command<uint8_t,CMD_LINE_SIZE> commands[] PROGMEM =
+  {
+    { "adc", &DebugMonitor::adc, helpAdc, true },
+    { "timer", &DebugMonitor::timer, nullptr }
+  };
+  static_assert(SABA::commandsSorted(commands), "commands must be sorted by name");
+
+  SABA::CmdLine<uint8_t,CMD_LINE_SIZE,&putch,SABA::OStream,execute> cmdline(commands);
+  ~~~ 
   */
-  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, PUTCH putch, template<PUTCH putch> class OStream, EXECUTE execute>
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, PUTCH putch, template<PUTCH> class OStream, EXECUTE execute>
   class CmdLine : public CmdReader<INDEX_TYPE, BUFFER_SIZE>
   {
   public:
+
+    typedef Command<INDEX_TYPE, BUFFER_SIZE> COMMAND; //! the command table entry type
+
+    CmdLine()
+    {
+    }
+
+    //! use a command table stored in FLASH, sorted by name
+    template<uint8_t COUNT> CmdLine(const COMMAND (&table)[COUNT]) : commands(table), commandCount(COUNT)
+    {
+    }
+
     void appendChar( char ch ) //! used to add a character to the buffer. The character will be echoed to the putch function. Backspace will delete the last character in the buffer. Enter will call the EXECUTE function. If the buffer is full, the character is not stored and echoed.
     {
       OStream<putch> ostr;
 
-      if( ch == 13 )
+      if( CmdReader<INDEX_TYPE, BUFFER_SIZE>::binaryMode )
+      {
+        if( transport.receive( uint8_t(ch) ) )
+          evaluateBinary();
+        return;
+      }
+
+      // only ESC STX is consumed, other escape sequences like the VT100 keys are handled as typed
+      if( escape )
+      {
+        escape= false;
+        if( ch == 2 )
+        {
+          CmdReader<INDEX_TYPE, BUFFER_SIZE>::binaryMode= true;
+          return;
+        }
+      }
+
+      if( ch == 27 )
+      {
+        escape= true;
+      }
+      else if( ch == 13 )
       {
         CmdReader<INDEX_TYPE, BUFFER_SIZE>::lineBuffer[indexIn]= 0;
         evaluateLine();
@@ -225,6 +591,49 @@ namespace SABA
 
     protected:
 
+    void evaluateBinary()
+    {
+      const uint8_t *data= transport.frame();
+      uint8_t length= transport.frameLength();
+
+      if( length == 0 )
+      {
+        CmdReader<INDEX_TYPE, BUFFER_SIZE>::binaryMode= false;
+        return;
+      }
+
+      CmdReader<INDEX_TYPE, BUFFER_SIZE>::binaryData= data;
+      CmdReader<INDEX_TYPE, BUFFER_SIZE>::binaryLength= length;
+      CmdReader<INDEX_TYPE, BUFFER_SIZE>::indexOut= 1;
+      CmdReader<INDEX_TYPE, BUFFER_SIZE>::error= false;
+      CmdReader<INDEX_TYPE, BUFFER_SIZE>::resultLength= 0;
+
+      uint8_t index= data[0];
+      uint8_t status;
+
+      // a handler without binary support would print its text into the response
+      if( index >= commandCount || !pgm_read_byte(&commands[index].binary) )
+      {
+        status= CmdUnknown;
+      }
+      else
+      {
+        typename COMMAND::HANDLER handler= (typename COMMAND::HANDLER)pgm_read_ptr(&commands[index].handler);
+        status= handler(*this) ? CmdOk : CmdFailed;
+      }
+
+      if( CmdReader<INDEX_TYPE, BUFFER_SIZE>::resultLength == CmdReader<INDEX_TYPE, BUFFER_SIZE>::RESULT_OVERFLOW )
+      {
+        status= CmdFailed;
+        CmdReader<INDEX_TYPE, BUFFER_SIZE>::resultLength= 0;
+      }
+
+      uint8_t *response= CmdReader<INDEX_TYPE, BUFFER_SIZE>::response;
+      response[0]= index;
+      response[1]= status;
+      transport.sendFrame(response, 2 + CmdReader<INDEX_TYPE, BUFFER_SIZE>::resultLength);
+    }
+
     void printError( const char *string )
     {
       OStream<putch> ostr;
@@ -243,13 +652,100 @@ namespace SABA
       CmdReader<INDEX_TYPE, BUFFER_SIZE>::indexOut= 0;
       CmdReader<INDEX_TYPE, BUFFER_SIZE>::error= false;
 
+      if( commandCount != 0 )
+      {
+        INDEX_TYPE length;
+        const char *word= CmdReader<INDEX_TYPE, BUFFER_SIZE>::nextWord(length);
+
+        const COMMAND *command= find(word, length);
+        if( command != nullptr )
+        {
+          typename COMMAND::HANDLER handler= (typename COMMAND::HANDLER)pgm_read_ptr(&command->handler);
+          if( !handler(*this) )
+            printError(PSTR("???"));
+
+          return;
+        }
+
+        if( compareName(word, length, PSTR("help")) == 0 )
+        {
+          help();
+          return;
+        }
+
+        CmdReader<INDEX_TYPE, BUFFER_SIZE>::indexOut= 0;
+      }
+
       if(!execute(CmdReader<INDEX_TYPE, BUFFER_SIZE>::nextCharIgnoreBlank()))
         printError(PSTR("???"));
     }
 
+    void help()
+    {
+      OStream<putch> ostr;
+      for(uint8_t i=0;i < commandCount;i++)
+      {
+        uint8_t n= 0;
+        char ch;
+        while( (ch= pgm_read_byte(commands[i].name + n)) != 0 )
+        {
+          ostr << ch;
+          ++n;
+        }
+
+        const char *text= (const char *)pgm_read_ptr(&commands[i].help);
+        if( text != nullptr )
+        {
+          for(;n < COMMAND_NAME_SIZE;n++)
+            ostr << ' ';
+          ostr << text;
+        }
+        ostr << endl;
+      }
+    }
+
+    //! compares the word with a name stored in FLASH like strcmp
+    static int8_t compareName(const char *word, INDEX_TYPE length, const char *name)
+    {
+      for(INDEX_TYPE i=0;;i++)
+      {
+        char w= i < length ? word[i] : 0;
+        char n= pgm_read_byte(name + i);
+        if( w != n )
+          return w < n ? -1 : 1;
+        if( w == 0 )
+          return 0;
+      }
+    }
+
+    //! binary search in the command table
+    const COMMAND *find(const char *word, INDEX_TYPE length)
+    {
+      uint8_t low= 0;
+      uint8_t high= commandCount;
+
+      while( low < high )
+      {
+        uint8_t middle= (low + high) / 2;
+        int8_t result= compareName(word, length, commands[middle].name);
+        if( result == 0 )
+          return commands + middle;
+        else if( result < 0 )
+          high= middle;
+        else
+          low= middle + 1;
+      }
+
+      return nullptr;
+    }
+
     private:
 
     INDEX_TYPE indexIn = 0;
+    const COMMAND *commands = nullptr;
+    uint8_t commandCount = 0;
+    bool escape = false;
+    FrameTransport<putch, (BUFFER_SIZE < 252 ? BUFFER_SIZE : 252)> transport;
   };
 
 }
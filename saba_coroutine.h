@@ -0,0 +1,102 @@
+/*
+ * saba_coroutine.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Stackless coroutines, protothread style, for sequences of asynchronous steps
+ */
+
+#ifndef SABA_COROUTINE_H_
+#define SABA_COROUTINE_H_
+
+#include <stdint.h>
+
+namespace SABA
+{
+  // \brief The resumable state of a stackless coroutine
+  /**
+  A coroutine is a member function returning bool, its body is enclosed in SABA_CO_BEGIN and SABA_CO_END. It is
+  resumed by calling it again, e.g. from the cyclic() method of the driver, it continues after the last await point
+  and returns false, while it waits, and true, if it reached the end. The state is the source line of the await
+  point, 2 bytes per coroutine, there is no stack per coroutine.
+  Local variables are not kept between two resumes, use member variables instead. The body must not contain a switch
+  statement with an await point inside, and only one await point per source line is allowed.
+  Awaitable are all non blocking conditions, e.g.
+  - a delay: SABA_CO_DELAY with a SABA::Timing::SingleDelay
+  - an I2C transaction: SABA::I2C::Transaction::write returns true, if the transaction is done
+  - a Fifo becoming non empty: SABA_CO_AWAIT(co, !fifo.isEmpty())
+
+  Usage:
+  ~~~{.c}
+  SABA::Coroutine co;
+  SABA::Timing::SingleDelay<uint8_t> delay;
+
+  bool blink()
+  {
+    SABA_CO_BEGIN(co);
+    for(;;)
+    {
+      SABA_CO_AWAIT(co, !rxFifo.isEmpty());
+      led= rxFifo.pop() == '1';
+      SABA_CO_DELAY(co, delay, 10);
+      led= false;
+    }
+    SABA_CO_END(co);
+  }
+
+  for(;;)
+  {
+    blink();
+  }
+  ~~~
+  */
+  class Coroutine
+  {
+    public:
+
+    void restart() //! the next resume starts at SABA_CO_BEGIN again
+    {
+      line= 0;
+    }
+
+    bool isStarted() //! true, if the coroutine waits at an await point
+    {
+      return line != 0;
+    }
+
+    uint16_t line= 0; //!< the source line of the await point, 0 at the start
+  };
+}
+
+//! starts the body of a coroutine, resumes at the last await point
+#define SABA_CO_BEGIN(CO)   switch((CO).line) { case 0:
+
+// the await point is reached by falling through and by the switch, older compilers don't know the attribute
+#if __GNUC__ >= 7
+#define SABA_CO_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define SABA_CO_FALLTHROUGH
+#endif
+
+//! returns false until the condition is true, the condition is evaluated again on each resume
+#define SABA_CO_AWAIT(CO, CONDITION) \
+  do { (CO).line= __LINE__; SABA_CO_FALLTHROUGH; case __LINE__: if( !(CONDITION) ) return false; } while(0)
+
+//! returns false once, the next resume continues after it, the label is reached by the switch only
+#define SABA_CO_YIELD(CO) \
+  do { (CO).line= __LINE__; return false; case __LINE__:; } while(0)
+
+//! starts the SABA::Timing::SingleDelay and awaits it
+#define SABA_CO_DELAY(CO, DELAY, TICKS) \
+  do { (DELAY).start(TICKS); SABA_CO_AWAIT(CO, (DELAY)()); } while(0)
+
+//! ends the coroutine and returns true, the next resume starts at the beginning
+#define SABA_CO_EXIT(CO)    do { (CO).line= 0; return true; } while(0)
+
+//! ends the body of a coroutine
+#define SABA_CO_END(CO)     } (CO).line= 0; return true
+
+#endif // SABA_COROUTINE_H_
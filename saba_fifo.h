@@ -9,19 +9,142 @@
 #ifndef SABA_FIFO_H_
 #define SABA_FIFO_H_
 
+#include <stdint.h>
+#include <saba_ostream.h>
+#include <saba_hexdump.h>
+
+//! compiler barrier, keeps buffer accesses on the correct side of an index update
+#define SABA_MEMORY_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
 namespace SABA
 {
+  // \brief Fifo statistics, disabled
+  /** 
+  The disabled statistics are empty, the methods compile to nothing.
+  */
+  template<bool ENABLED>
+  class FifoStatistics
+  {
+    protected:
+
+      void registerFifo(const char * /*name*/, uint16_t /*size*/)
+      {
+      }
+
+      void countPush(uint16_t /*count*/, uint16_t /*allocation*/)
+      {
+      }
+
+      void countPushFailure(uint16_t /*count*/)
+      {
+      }
+  };
+
+  // \brief Fifo statistics, enabled
+  /** 
+  Counts the pushed values, the failed pushes and keeps the high water mark of the allocation.
+  A registered FIFO is listed by Monitor::fifos. There is no unregister, only static FIFOs may be registered.
+  */
+  template<>
+  class FifoStatistics<true>
+  {
+    public:
+
+      //! the first registered FIFO statistics, the list is linked by next()
+      static FifoStatistics*& first()
+      {
+        static FifoStatistics *list= nullptr;
+
+        return list;
+      }
+
+      FifoStatistics *next() //! the next registered FIFO statistics, nullptr at the end
+      {
+        return nextStatistics;
+      }
+
+      const char *name() //! the registered name, stored in FLASH
+      {
+        return fifoName;
+      }
+
+      uint16_t size() //! the size of the FIFO
+      {
+        return fifoSize;
+      }
+
+      uint16_t highWater() //! the maximum number of values stored in the FIFO
+      {
+        return highWaterMark;
+      }
+
+      uint16_t pushFailures() //! the number of values not pushed, because the FIFO was full
+      {
+        return pushFailureCount;
+      }
+
+      uint32_t pushCount() //! the total number of pushed values
+      {
+        return pushTotal;
+      }
+
+    protected:
+
+      void registerFifo(const char *name, uint16_t size)
+      {
+        // registered twice would link the FIFO to itself
+        if( fifoName != nullptr )
+          return;
+
+        fifoName= name;
+        fifoSize= size;
+        nextStatistics= first();
+        first()= this;
+      }
+
+      void countPush(uint16_t count, uint16_t allocation)
+      {
+        pushTotal += count;
+        if( allocation > highWaterMark )
+          highWaterMark= allocation;
+      }
+
+      void countPushFailure(uint16_t count)
+      {
+        pushFailureCount += count;
+      }
+
+    private:
+
+      FifoStatistics *nextStatistics = nullptr;
+      const char *fifoName = nullptr;
+      uint16_t fifoSize = 0;
+      uint16_t highWaterMark = 0;
+      uint16_t pushFailureCount = 0;
+      uint32_t pushTotal = 0;
+  };
+
   // \brief A Fifo ring memory
   /** 
   A template class to access a single bit in an AVR special function register. 
   @tparam FIFO_TYPE the type to store in the FIFO
   @tparam INDEX_TYPE the index type, use uint8_t for < 255 or uint16_t for more
   @tparam the size of the memory    
+  @tparam STATISTICS true to count pushes, push failures and the high water mark, see FifoStatistics
   */
-  template<typename FIFO_TYPE, typename INDEX_TYPE, INDEX_TYPE size>
-  class Fifo
+  template<typename FIFO_TYPE, typename INDEX_TYPE, INDEX_TYPE size, bool STATISTICS = false>
+  class Fifo : public FifoStatistics<STATISTICS>
   {
     public:
+
+      /** add the FIFO to the list printed by Monitor::fifos, only if STATISTICS is enabled
+       * The FIFO has to be static, it stays in the list. A second call is ignored.
+       * @param name: the name, use PSTR("xxx") as a string stored in FLASH
+      */
+      void registerStatistics(const char *name)
+      {
+        this->registerFifo(name, size);
+      }
     
       /** push a value on the FIFO
        * @param data: the value to push
@@ -30,7 +153,10 @@ namespace SABA
       bool push(FIFO_TYPE data)
       {
         if( isFull())
+        {
+          this->countPushFailure(1);
           return false;
+        }
           
         buffer[writeIndex++] = data;
         if( writeIndex >= size )
@@ -38,6 +164,7 @@ namespace SABA
           writeIndex= 0;
         }
         allocation++;
+        this->countPush(1, allocation);
         
         return true;
       }
@@ -77,29 +204,131 @@ namespace SABA
       {
         return allocation >= size;
       }
-    
-    void dumpFifo()
-    {
-      out << PSTR("WI: ") << SABA::hex << writeIndex << PSTR(" RI: ") << readIndex << PSTR(" AL: ") << allocation << SABA::endl;
-      for(INDEX_TYPE i=0;i < writeIndex;i+= 16)
+
+      /** reserve free memory for writing, without copying. Fill the memory and call commit() afterwards.
+       * @param data: receives a pointer to the first free element
+       * @param count: the number of elements wanted
+       * @return the number of contiguous free elements up to the wrap point, at most count
+      */
+      INDEX_TYPE reserve(FIFO_TYPE*& data, INDEX_TYPE count)
+      {
+        INDEX_TYPE contiguous= size - writeIndex;
+        if( contiguous > INDEX_TYPE(size - allocation) )
+          contiguous= size - allocation;
+        if( contiguous > count )
+          contiguous= count;
+
+        data= &buffer[writeIndex];
+
+        return contiguous;
+      }
+
+      /** commit elements written into the memory returned by reserve()
+       * @param count: the number of elements written, at most the value returned by reserve()
+      */
+      void commit(INDEX_TYPE count)
+      {
+        writeIndex += count;
+        if( writeIndex >= size )
+        {
+          writeIndex -= size;
+        }
+        allocation += count;
+        this->countPush(count, allocation);
+      }
+
+      /** access the stored elements without copying. Call consume() afterwards.
+       * @param data: receives a pointer to the oldest element
+       * @return the number of contiguous elements up to the wrap point
+      */
+      INDEX_TYPE peekContiguous(const FIFO_TYPE*& data)
+      {
+        INDEX_TYPE contiguous= size - readIndex;
+        if( contiguous > allocation )
+          contiguous= allocation;
+
+        data= &buffer[readIndex];
+
+        return contiguous;
+      }
+
+      /** remove elements read via peekContiguous()
+       * @param count: the number of elements to remove, at most the value returned by peekContiguous()
+      */
+      void consume(INDEX_TYPE count)
+      {
+        readIndex += count;
+        if( readIndex >= size )
+        {
+          readIndex -= size;
+        }
+        allocation -= count;
+      }
+
+      /** push a block of values on the FIFO
+       * @param data: the values to push
+       * @param count: the number of values
+       * @return the number of values pushed, less than count, if the FIFO got full
+      */
+      INDEX_TYPE pushBlock(const FIFO_TYPE *data, INDEX_TYPE count)
+      {
+        INDEX_TYPE pushed= 0;
+
+        // at most two rounds, before and after the wrap point
+        for(uint8_t round= 0;round < 2 && pushed < count;round++)
+        {
+          FIFO_TYPE *dest;
+          INDEX_TYPE n= reserve(dest, count - pushed);
+          if( n == 0 )
+            break;
+
+          for(INDEX_TYPE i=0;i < n;i++)
+            dest[i]= *data++;
+
+          commit(n);
+          pushed += n;
+        }
+
+        if( pushed < count )
+          this->countPushFailure(count - pushed);
+
+        return pushed;
+      }
+
+      /** pop a block of values from the FIFO
+       * @param data: receives the values
+       * @param count: the maximum number of values
+       * @return the number of values popped, less than count, if the FIFO got empty
+      */
+      INDEX_TYPE popBlock(FIFO_TYPE *data, INDEX_TYPE count)
       {
-        for(INDEX_TYPE n=0;n < 16;n++ )
-          out << uint8_t(buffer[i+n]) << ' ';
+        INDEX_TYPE popped= 0;
 
-        out << ' ';
-        for(INDEX_TYPE n=0;n < 16;n++ )
+        // at most two rounds, before and after the wrap point
+        for(uint8_t round= 0;round < 2 && popped < count;round++)
         {
-          char ch= buffer[i+n];
-          if( ch < ' ')
-            ch= '.';
+          const FIFO_TYPE *src;
+          INDEX_TYPE n= peekContiguous(src);
+          if( n == 0 )
+            break;
+          if( n > INDEX_TYPE(count - popped) )
+            n= count - popped;
+
+          for(INDEX_TYPE i=0;i < n;i++)
+            *data++= src[i];
 
-          out << ch;
+          consume(n);
+          popped += n;
         }
 
-        out << SABA::endl;
+        return popped;
       }
 
-      readIndex= writeIndex= allocation= 0;
+    //! print the FIFO state and the memory to the stream, the FIFO is not changed
+    template<class OSTREAM> void dumpFifo(OSTREAM& out)
+    {
+      out << PSTR("WI: ") << SABA::hex << writeIndex << PSTR(" RI: ") << readIndex << PSTR(" AL: ") << allocation << SABA::endl;
+      hexdump(out, RamReader(buffer), 0, sizeof(buffer));
     }
       
     private:
@@ -109,6 +338,114 @@ namespace SABA
       INDEX_TYPE readIndex = 0;
       INDEX_TYPE allocation = 0;
   };
+
+  // \brief A lock free single producer / single consumer Fifo ring memory
+  /** 
+  The producer (e.g. an ISR) only writes the writeIndex, the consumer (e.g. the main loop) only writes the readIndex. 
+  Both indices are free running 8 bit counters, the buffer position is masked. Each index update is a single 
+  byte store, so no cli/sei is needed, as long as there is only one producer and one consumer.
+  @tparam FIFO_TYPE the type to store in the FIFO
+  @tparam size the size of the memory, a power of two up to 128
+
+  Usage:
+  ~~~{.c}
+  SABA::SpscFifo<uint8_t,32> rxFifo;
+
+  ISR(USART_RX_vect)
+  {
+    rxFifo.push(UDR0);
+  }
+
+  if( !rxFifo.isEmpty() )
+    cmdline.appendChar(rxFifo.pop());
+  ~~~ 
+  */
+  template<typename FIFO_TYPE, uint8_t size>
+  class SpscFifo
+  {
+    static_assert(size != 0 && (size & (size - 1)) == 0, "SpscFifo size must be a power of two");
+    static_assert(size <= 128, "SpscFifo size must be <= 128");
+
+    public:
+
+      /** push a value on the FIFO, only called by the producer
+       * @param data: the value to push
+       * @return true, if successful, false, if the FIFO was full
+      */
+      bool push(FIFO_TYPE data)
+      {
+        uint8_t wi= writeIndex;
+        if( uint8_t(wi - readIndex) >= size )
+          return false;
+
+        buffer[wi & MASK]= data;
+        SABA_MEMORY_BARRIER();
+        writeIndex= wi + 1;
+
+        return true;
+      }
+
+      /** pop a value from the FIFO, only called by the consumer
+       * @return  a value from FIFO, 0 if it was empty
+      */
+      FIFO_TYPE pop()
+      {
+        FIFO_TYPE ret= 0;
+
+        pop(ret);
+
+        return ret;
+      }
+
+      /** pop a value from the FIFO, only called by the consumer
+       * @param data: receives the value, unchanged if the FIFO was empty
+       * @return true, if successful, false, if the FIFO was empty
+      */
+      bool pop(FIFO_TYPE& data)
+      {
+        uint8_t ri= readIndex;
+        if( ri == writeIndex )
+          return false;
+
+        data= buffer[ri & MASK];
+        SABA_MEMORY_BARRIER();
+        readIndex= ri + 1;
+
+        return true;
+      }
+
+      /** check, if the FIFO is empty
+       * @return true, if the FIFO is empty
+      */
+      bool isEmpty()
+      {
+        return readIndex == writeIndex;
+      }
+
+      /** check, if the FIFO is full
+       * @return true, if the FIFO is full
+      */
+      bool isFull()
+      {
+        return uint8_t(writeIndex - readIndex) >= size;
+      }
+
+      /** the number of values in the FIFO
+       * @return the number of values ready to pop
+      */
+      uint8_t available()
+      {
+        return uint8_t(writeIndex - readIndex);
+      }
+
+    private:
+
+      static constexpr uint8_t MASK = size - 1;
+
+      FIFO_TYPE buffer[size];
+      volatile uint8_t writeIndex = 0;
+      volatile uint8_t readIndex = 0;
+  };
 }
 
 #endif // SABA_FIFO_H_
@@ -0,0 +1,225 @@
+/*
+ * saba_format.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Compile time parsed format strings for OStream
+ */
+
+#ifndef SABA_FORMAT_H_
+#define SABA_FORMAT_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#include <saba_ostream.h>
+
+/** print the arguments formatted to an OStream
+ * The format string is parsed at compile time. Each {} is replaced by the next argument:
+ * {} serializes like operator <<, {:x} as hexadecimal, {:d} as decimal integer, {:c} as char.
+ * The number of placeholders and the argument types are checked at compile time.
+ * The literals between the placeholders are stored in one string in FLASH without the placeholders.
+ * Each call site instantiates its own print steps, call a function with the SABA_FORMAT from many places.
+ *
+ * Usage:
+ * ~~~{.c}
+ * SABA_FORMAT(out, "TCCR{}A: {:x} TCNT{}: {:d}\r\n", '1', TCCR1A, '1', TCNT1);
+ * ~~~
+ */
+#define SABA_FORMAT(STREAM, FORMAT, ...)                                            \
+  do                                                                                \
+  {                                                                                 \
+    struct SabaFormatString                                                         \
+    {                                                                               \
+      static constexpr const char *str() { return FORMAT; }                         \
+    };                                                                              \
+    SABA::Format::print<SabaFormatString>(STREAM, ##__VA_ARGS__);                   \
+  }                                                                                 \
+  while(0)
+
+namespace SABA
+{
+  /**
+   @namespace SABA::Format
+   @brief Compile time format string parser used by SABA_FORMAT
+  */
+  namespace Format
+  {
+    //! the type categories accepted by the placeholders
+    template<typename T> struct Category { static constexpr uint8_t value = 0; };
+    template<> struct Category<uint8_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<int8_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<uint16_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<int16_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<uint32_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<int32_t> { static constexpr uint8_t value = 1; };
+    template<> struct Category<char> { static constexpr uint8_t value = 2; };
+    template<> struct Category<bool> { static constexpr uint8_t value = 3; };
+    template<> struct Category<const char *> { static constexpr uint8_t value = 4; };
+    template<> struct Category<char *> { static constexpr uint8_t value = 4; };
+
+    static constexpr uint8_t INTEGER = 1;
+    static constexpr uint8_t CHAR = 2;
+
+    //! the length of the string
+    constexpr uint16_t length(const char *str, uint16_t pos = 0)
+    {
+      return str[pos] == 0 ? pos : length(str, pos + 1);
+    }
+
+    //! the position of the next character ch, starting at pos, the string length if not found
+    constexpr uint16_t find(const char *str, char ch, uint16_t pos)
+    {
+      return (str[pos] == 0 || str[pos] == ch) ? pos : find(str, ch, pos + 1);
+    }
+
+    //! the position after the '}' of the next placeholder, starting at pos, the string length if not found
+    constexpr uint16_t skip(const char *str, uint16_t pos)
+    {
+      return str[find(str, '}', find(str, '{', pos))] == 0 ? length(str) : find(str, '}', find(str, '{', pos)) + 1;
+    }
+
+    //! the position of the '{' of placeholder index, the string length if not found
+    constexpr uint16_t open(const char *str, uint8_t index, uint16_t pos = 0)
+    {
+      return index == 0 ? find(str, '{', pos) : open(str, index - 1, skip(str, pos));
+    }
+
+    //! the position of the '}' of placeholder index
+    constexpr uint16_t close(const char *str, uint8_t index)
+    {
+      return find(str, '}', open(str, index));
+    }
+
+    //! the start of the literal before placeholder index
+    constexpr uint16_t literal(const char *str, uint8_t index)
+    {
+      return index == 0 ? 0 : close(str, index - 1) + 1;
+    }
+
+    //! the number of placeholders
+    constexpr uint8_t count(const char *str, uint8_t index = 0)
+    {
+      return str[open(str, index)] == 0 ? index : count(str, index + 1);
+    }
+
+    //! true, if every placeholder is closed before the next one is opened
+    constexpr bool balanced(const char *str, uint8_t index = 0)
+    {
+      return str[open(str, index)] == 0 ? find(str, '}', literal(str, index)) == length(str) :
+        (str[close(str, index)] == '}' && find(str, '{', open(str, index) + 1) > close(str, index)
+          && find(str, '}', literal(str, index)) > open(str, index) && balanced(str, index + 1));
+    }
+
+    //! the format character of placeholder index, 0 for {}
+    constexpr char spec(const char *str, uint8_t index)
+    {
+      return close(str, index) == open(str, index) + 1 ? 0 :
+        (str[open(str, index) + 1] == ':' && close(str, index) == open(str, index) + 3 ? str[open(str, index) + 2] : '?');
+    }
+
+    //! the number of literal characters before placeholder index
+    constexpr uint16_t text(const char *str, uint8_t index)
+    {
+      return index == 0 ? open(str, 0) : text(str, index - 1) + open(str, index) - literal(str, index);
+    }
+
+    //! the literal character i, without the placeholders
+    constexpr char textChar(const char *str, uint16_t i, uint8_t index = 0)
+    {
+      return i < text(str, index) ? str[literal(str, index) + i - (index == 0 ? 0 : text(str, index - 1))] : textChar(str, i, index + 1);
+    }
+
+    template<uint16_t... I> struct Indices {};
+    template<uint16_t N, uint16_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+    template<uint16_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+    //! the literals of the FORMAT string in FLASH
+    template<class FORMAT, class INDICES> struct Text;
+    template<class FORMAT, uint16_t... I> struct Text<FORMAT, Indices<I...> >
+    {
+      static const char str[sizeof...(I) + 1] PROGMEM;
+    };
+
+    template<class FORMAT, uint16_t... I> const char Text<FORMAT, Indices<I...> >::str[sizeof...(I) + 1] PROGMEM = { textChar(FORMAT::str(), I)..., 0 };
+
+    //! true, if the placeholder format character is valid for the argument category
+    constexpr bool accepts(char spec, uint8_t category)
+    {
+      return category != 0 && (spec == 0 ||
+        ((spec == 'x' || spec == 'd') && category == INTEGER) ||
+        (spec == 'c' && category == CHAR));
+    }
+
+    template<class STREAM> void printLiteral(STREAM& stream, const char *blob, uint16_t length)
+    {
+      for(;length != 0;length--)
+        stream << char(pgm_read_byte(blob++));
+    }
+
+    template<char SPEC> struct Value
+    {
+      template<class STREAM, typename T> static void print(STREAM& stream, T value)
+      {
+        stream << value;
+      }
+    };
+
+    template<> struct Value<'x'>
+    {
+      template<class STREAM, typename T> static void print(STREAM& stream, T value)
+      {
+        ios_base::_Fmtflags flags= stream.setf(0);
+        stream.setf(ios_base::hex, ios_base::base);
+        stream << value;
+        stream.setf(flags, ios_base::base);
+      }
+    };
+
+    template<> struct Value<'d'>
+    {
+      template<class STREAM, typename T> static void print(STREAM& stream, T value)
+      {
+        ios_base::_Fmtflags flags= stream.setf(0);
+        stream.setf(ios_base::dec, ios_base::base);
+        stream << value;
+        stream.setf(flags, ios_base::base);
+      }
+    };
+
+    //! prints the literal and the argument of placeholder INDEX, then the next one
+    template<class FORMAT, uint8_t INDEX>
+    struct Step
+    {
+      template<class STREAM, typename T, typename... REST> static void print(STREAM& stream, const char *str, T value, REST... rest)
+      {
+        static_assert(accepts(spec(FORMAT::str(), INDEX), Category<T>::value), "format placeholder does not accept the argument type");
+
+        printLiteral(stream, str + (INDEX == 0 ? 0 : text(FORMAT::str(), INDEX - 1)), open(FORMAT::str(), INDEX) - literal(FORMAT::str(), INDEX));
+        Value<spec(FORMAT::str(), INDEX)>::print(stream, value);
+        Step<FORMAT, INDEX + 1>::print(stream, str, rest...);
+      }
+
+      template<class STREAM> static void print(STREAM& stream, const char *str)
+      {
+        printLiteral(stream, str + (INDEX == 0 ? 0 : text(FORMAT::str(), INDEX - 1)), length(FORMAT::str()) - literal(FORMAT::str(), INDEX));
+      }
+    };
+
+    //! used by SABA_FORMAT
+    template<class FORMAT, class STREAM, typename... ARGS> void print(STREAM& stream, ARGS... args)
+    {
+      static_assert(balanced(FORMAT::str()), "format placeholder not closed");
+      static_assert(count(FORMAT::str()) == sizeof...(ARGS), "format placeholder count does not match the argument count");
+
+      typedef Text<FORMAT, typename MakeIndices<text(FORMAT::str(), count(FORMAT::str()))>::type> FormatText;
+
+      Step<FORMAT, 0>::print(stream, FormatText::str, args...);
+    }
+  }
+}
+
+#endif // SABA_FORMAT_H_
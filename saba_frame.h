@@ -0,0 +1,193 @@
+/*
+ * saba_frame.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * COBS framed binary transport with CRC16
+ */
+
+#ifndef SABA_FRAME_H_
+#define SABA_FRAME_H_
+
+#include <stdint.h>
+#include <saba_ostream.h>
+
+namespace SABA
+{
+  //! CRC-CCITT update, same polynomial and bit order as avr-libc _crc_ccitt_update(), start with 0xffff
+  inline uint16_t crc16Update(uint16_t crc, uint8_t data)
+  {
+    data ^= uint8_t(crc);
+    data ^= uint8_t(data << 4);
+
+    return ((uint16_t(data) << 8) | uint8_t(crc >> 8)) ^ uint8_t(data >> 4) ^ (uint16_t(data) << 3);
+  }
+
+  //! the callback called for a received frame with correct CRC
+  typedef void (*FRAME_RECEIVED)(const uint8_t *data, uint8_t length);
+
+  // \brief COBS framed binary transport
+  /**
+  Sends and receives binary frames over a byte stream, e.g. a Usart. The payload is followed by a CRC16 (low byte first),
+  both are COBS encoded, so the frame contains no 0 byte. A 0 byte terminates the frame.
+  A corrupted frame is dropped, the receiver synchronizes again on the next 0 byte.
+  @tparam putch The putch function receiving the encoded output
+  @tparam MAX_PAYLOAD the maximum payload size, the size of the receive buffer, max 252
+  @tparam FRAME_RECEIVED The function called after a frame with correct CRC has been received, optional, receive()
+  returns true for it, too
+
+  Usage:
+  ~~~{.c}
+  void frameReceived(const uint8_t *data, uint8_t length)
+  {
+  }
+
+  SABA::FrameTransport<&putch,32,&frameReceived> transport;
+
+  transport.sendFrame( (const uint8_t *)&telemetry, sizeof(telemetry));
+
+  while(usart.available())
+    transport.receive(usart.read());
+  ~~~
+  */
+  template<PUTCH putch, uint8_t MAX_PAYLOAD, FRAME_RECEIVED frameReceived = nullptr>
+  class FrameTransport
+  {
+    static_assert(MAX_PAYLOAD <= 252, "FrameTransport payload must be <= 252");
+
+  public:
+
+    void sendFrame(const uint8_t *data, uint8_t length) //! encodes and sends a frame, a payload longer than MAX_PAYLOAD is not sent
+    {
+      if( length > MAX_PAYLOAD )
+        return;
+
+      uint16_t crc= 0xffff;
+      for(uint8_t i=0;i < length;i++)
+        crc= crc16Update(crc, data[i]);
+
+      const uint8_t frameLength= length + 2;
+      uint8_t blockStart= 0;
+
+      // a COBS block has up to 254 data bytes, the frame can not reach this size
+      for(;;)
+      {
+        uint8_t blockEnd= blockStart;
+        while( blockEnd < frameLength && frameByte(data, length, crc, blockEnd) != 0 )
+          ++blockEnd;
+
+        putch( blockEnd - blockStart + 1 );
+        for(uint8_t i=blockStart;i < blockEnd;i++)
+          putch( frameByte(data, length, crc, i) );
+
+        if( blockEnd >= frameLength )
+          break;
+
+        blockStart= blockEnd + 1;
+      }
+
+      putch( 0 );
+    }
+
+    bool receive(uint8_t ch) //! decodes a received byte, returns true and calls the FRAME_RECEIVED function, if a frame is complete
+    {
+      bool received= false;
+
+      if( ch == 0 )
+      {
+        if( !overflow && remaining == 0 && index >= 2 )
+        {
+          uint16_t crc= 0xffff;
+          for(uint8_t i=0;i < index - 2;i++)
+            crc= crc16Update(crc, buffer[i]);
+
+          if( uint8_t(crc) == buffer[index - 2] && uint8_t(crc >> 8) == buffer[index - 1] )
+          {
+            payloadLength= index - 2;
+            received= true;
+            if( frameReceived != nullptr )
+              frameReceived(buffer, payloadLength);
+          }
+          else
+          {
+            ++errorCount;
+          }
+        }
+        else if( overflow || index != 0 || code != 0 )
+        {
+          ++errorCount;
+        }
+
+        index= 0;
+        code= 0;
+        remaining= 0;
+        overflow= false;
+      }
+      else if( remaining == 0 )
+      {
+        // a new block, the previous one ended with an implicit 0
+        if( code != 0 && code != 0xff )
+          append( 0 );
+
+        code= ch;
+        remaining= ch - 1;
+      }
+      else
+      {
+        append( ch );
+        --remaining;
+      }
+
+      return received;
+    }
+
+    const uint8_t *frame() //! the payload of the last received frame, valid until the next byte is received
+    {
+      return buffer;
+    }
+
+    uint8_t frameLength() //! the payload length of the last received frame
+    {
+      return payloadLength;
+    }
+
+    uint8_t errors() //! the number of dropped frames, because of a CRC, length or encoding error
+    {
+      return errorCount;
+    }
+
+  private:
+
+    //! the payload followed by the CRC low and high byte
+    static uint8_t frameByte(const uint8_t *data, uint8_t length, uint16_t crc, uint8_t i)
+    {
+      if( i < length )
+        return data[i];
+      else if( i == length )
+        return uint8_t(crc);
+      else
+        return uint8_t(crc >> 8);
+    }
+
+    void append(uint8_t ch)
+    {
+      if( index < sizeof(buffer) )
+        buffer[index++]= ch;
+      else
+        overflow= true;
+    }
+
+    uint8_t buffer[MAX_PAYLOAD + 2];
+    uint8_t index = 0;
+    uint8_t payloadLength = 0;
+    uint8_t code = 0;
+    uint8_t remaining = 0;
+    bool overflow = false;
+    uint8_t errorCount = 0;
+  };
+}
+
+#endif // SABA_FRAME_H_
@@ -0,0 +1,135 @@
+/*
+ * saba_hexdump.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Hex and ASCII dump of RAM, FLASH or EEPROM to an OStream
+ */
+
+#ifndef SABA_HEXDUMP_H_
+#define SABA_HEXDUMP_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+
+namespace SABA
+{
+  //! the hex digits used by hexdump
+  const char HEX_DIGITS[] PROGMEM = "0123456789ABCDEF";
+
+  //! the number of bytes per hexdump row
+  static constexpr uint8_t HEXDUMP_ROW = 16;
+
+  //! hexdump source reading RAM, the address is relative to base
+  class RamReader
+  {
+    public:
+
+    RamReader(const void *base = nullptr) : base(uintptr_t(base))
+    {
+    }
+
+    uint8_t operator()(uint16_t address) const
+    {
+      return *(const uint8_t *)(base + address);
+    }
+
+    private:
+
+    uintptr_t base;
+  };
+
+  //! hexdump source reading FLASH
+  class ProgmemReader
+  {
+    public:
+
+    uint8_t operator()(uint16_t address) const
+    {
+      return pgm_read_byte((const uint8_t *)uintptr_t(address));
+    }
+  };
+
+  //! hexdump source reading EEPROM
+  class EepromReader
+  {
+    public:
+
+    uint8_t operator()(uint16_t address) const
+    {
+      return eeprom_read_byte((const uint8_t *)uintptr_t(address));
+    }
+  };
+
+  //! writes the two hex digits of b
+  inline char *hexdumpByte(char *p, uint8_t b)
+  {
+    *p++= pgm_read_byte(HEX_DIGITS + (b >> 4));
+    *p++= pgm_read_byte(HEX_DIGITS + (b & 0xf));
+
+    return p;
+  }
+
+  /** print a hex and ASCII dump, 16 bytes per row
+   * Each row is formatted into a buffer on the stack and printed at once. The source is only read.
+   * @param stream: the output stream
+   * @param source: the reader, RamReader, ProgmemReader or EepromReader
+   * @param start: the address of the first byte, printed at the start of the row
+   * @param length: the number of bytes
+   *
+   * Usage:
+   * ~~~{.c}
+   * SABA::hexdump(out, SABA::EepromReader(), 0x20, 64);
+   * SABA::hexdump(out, SABA::RamReader(buffer), 0, sizeof(buffer));
+   * ~~~
+   */
+  template<class STREAM, class READER> void hexdump(STREAM& stream, const READER& source, uint16_t start, uint16_t length)
+  {
+    // "AAAA:", " XX" per byte, two blanks, the ASCII characters, CR LF and 0
+    char row[5 + HEXDUMP_ROW * 3 + 2 + HEXDUMP_ROW + 3];
+    char *ascii= row + 5 + HEXDUMP_ROW * 3 + 2;
+
+    while( length != 0 )
+    {
+      uint8_t count= length < HEXDUMP_ROW ? uint8_t(length) : HEXDUMP_ROW;
+
+      char *p= hexdumpByte(row, uint8_t(start >> 8));
+      p= hexdumpByte(p, uint8_t(start));
+      *p++= ':';
+
+      for(uint8_t i=0;i < HEXDUMP_ROW;i++)
+      {
+        *p++= ' ';
+        if( i < count )
+        {
+          uint8_t b= source(uint16_t(start + i));
+          p= hexdumpByte(p, b);
+          ascii[i]= (b < ' ' || b > '~') ? '.' : char(b);
+        }
+        else
+        {
+          *p++= ' ';
+          *p++= ' ';
+        }
+      }
+      *p++= ' ';
+      *p= ' ';
+
+      p= ascii + count;
+      *p++= '\r';
+      *p++= '\n';
+      *p= 0;
+
+      stream.print(row);
+
+      start += count;
+      length -= count;
+    }
+  }
+}
+
+#endif // SABA_HEXDUMP_H_
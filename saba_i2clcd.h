@@ -10,6 +10,7 @@
 #define SABA_LcdText_H_
 
 #include "saba_timing.h"
+#include "saba_coroutine.h"
 #include "saba_i2cm.h"
 
 // The I2C Input/Output Bits to the LCD Controller
@@ -41,89 +42,29 @@ namespace SABA
     {
     public:
 
-      LcdText(SABA::I2C::I2CMaster& master, uint8_t address) : master(&master), address(address) { } //! Constructs the Driver, set the I2CMaster
+      LcdText(SABA::I2C::I2CMaster& master, uint8_t address) : transaction(master), address(address) { } //! Constructs the Driver, set the I2CMaster
   
       typedef void(*ERROR_RETURN)(uint8_t errorCode);
-      typedef void(*WRITE_RETURN)(void *env);
       typedef void(*Callback)(void *env);
   
-    /** Initialize the Display, function blocks only, if the I2CMaster is busy.
+    /** Initialize the Display, the function does not block, the initialization runs in cyclic().
       * @param initReturn: callback in case of successful initialization.
       * @param errorReturn: callback in case of any Error, the error callback is stored and also called from other methods
       */
       void initialize(Callback initReturn, ERROR_RETURN errorReturn, void *callbackEnv = nullptr)
       {
-        // wait, if I2C Master is busy
-        while((*master)());
-    
-        context2= (void*)initReturn;
-        contextEnv= callbackEnv;
         this->errorReturn= errorReturn;
-        master->startWrite(address, 1, &orMask,[](void *env, SABA::I2C::CMD* cmd)
-        {
-          LcdText *me= (LcdText*)env;
-          me->callbackDelay.start(100, env, [](void *env)
-          {
-            LcdText *me= (LcdText*)env;
-            me->writeNibble(0x30, [](void *env)
-            {
-              LcdText *me= (LcdText*)env;
-              me->callbackDelay.start(5, env, [](void *env)
-              {
-                LcdText *me= (LcdText*)env;
-                me->writeNibble(0x30, [](void *env)
-                {
-                  LcdText *me= (LcdText*)env;
-                  me->callbackDelay.start(5, env, [](void *env)
-                  {
-                    LcdText *me= (LcdText*)env;
-                    me->writeNibble(0x30, [](void *env)
-                    {
-                      LcdText *me= (LcdText*)env;
-                      me->callbackDelay.start(1, env, [](void *env)
-                      {
-                        LcdText *me= (LcdText*)env;
-                        me->writeNibble(0x20, [](void *env)
-                        {
-                          LcdText *me= (LcdText*)env;                    
-                          me->write(0x28 | (DISPLAY_LINES ? 8 : 0) | (FONT ? 4 : 0), [](void *env)
-                          {
-                            LcdText *me= (LcdText*)env;
-                            me->write( 0x0c, [](void *env)
-                            {
-                              LcdText *me= (LcdText*)env;
-                              me->write( 0x01, [](void *env)
-                              {
-                                LcdText *me= (LcdText*)env;
-                                me->write( 0x6, [](void *env)
-                                {
-                                  LcdText *me= (LcdText*)env;
-                                  me->initialized= true;
-                                  ((Callback)me->context2)( me->contextEnv );
-                                });
-                              });
-                            });
-                          });
-                        });
-                      });
-                    });
-                  });
-                });
-              });
-            });
-          });
-   
-        },(void*)this);
+        start(Initialize, 0, initReturn, callbackEnv);
       }
   
     /** Turn on or off the Backlight
       * @param on: true= Backlight on, false= Backlight off
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool backlight( bool on, Callback callback= nullptr, void *callbackEnv = nullptr )
       {
-        if((*master)())
+        if( isBusy() )
           return false;
       
         if(on)
@@ -131,21 +72,13 @@ namespace SABA
         else
           orMask &= ~_BV(LCD_BACKLIGHT);
     
-        context2= (void*)callback;
-        contextEnv= callbackEnv;
-        return master->startWrite(address, 1, &orMask, [](void *env, SABA::I2C::CMD* cmd)
-        {
-          LcdText *me= (LcdText*)env;
-          if( cmd->error != 0 )
-            me->errorReturn(cmd->error);
-          else if(me->context2 != nullptr)
-            ((Callback)me->context2)(me->contextEnv);        
-        }, (void*)this);
+        start(Backlight, 0, callback, callbackEnv);
+        return true;
       }
   
     /** Clear the LCD screen
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool clearScreen(Callback callback= nullptr, void *callbackEnv = nullptr)
       {
@@ -154,7 +87,7 @@ namespace SABA
 
     /** Cursor home
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool home(Callback callback= nullptr, void *callbackEnv = nullptr)
       {
@@ -166,7 +99,7 @@ namespace SABA
       * @param cursorOn: Cursor on (true) or off (false)
       * @param cursorBlink: Cursor is blinking (true) or not (false)
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool display(bool on, bool cursorOn, bool cursorBlink, Callback callback= nullptr, void *callbackEnv = nullptr)
       {
@@ -184,18 +117,19 @@ namespace SABA
     /** Set the Display Data Ram Address
       * @param address: The data Ram address
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool ddram(uint8_t address, Callback callback= nullptr, void *callbackEnv = nullptr)
       {
         return command( 0x80 | address, callback, callbackEnv);
       }
   
-    /** Cyclic has to be called regularly, it is the internal state machine
+    /** Cyclic has to be called regularly, it resumes the running command
       */
       void cyclic()
       {
-        callbackDelay.cyclic();
+        if( job != Idle )
+          resume();
       }
   
     /** test, if the display has been initialized
@@ -206,95 +140,140 @@ namespace SABA
         return initialized;
       }
   
+    /** test, if a command is running
+      * @return true, if a command is running, a new one will not be sent
+      */
       bool isBusy()
       {
-        return (*master)() || callbackDelay();
+        return job != Idle;
       }
 
     /** non blocking putch function
       * @param ch: char to print
       * @param callback: the optional callback, called on successful command
-      * @return false, if I2C Hardware is busy, command will not be sent
+      * @return false, if the display is busy, command will not be sent
       */
       bool putch(uint8_t ch, Callback putchReturn = nullptr, void *callbackEnv = nullptr)
       {
-        if((*master)())
+        if( isBusy() )
           return false;
           
-        context2= (void*)putchReturn;
-        contextEnv= callbackEnv;
-
         orMask |= _BV(LCD_RS);
-        return write(ch, [](void *env)
-        {
-          LcdText *me= (LcdText*)env;
-          if(me->context2 != nullptr)
-            ((Callback)me->context2)( me->contextEnv );
-        });
+        start(Data, ch, putchReturn, callbackEnv);
+        return true;
       }
 
     private:
 
+      enum Job
+      {
+        Idle= 0, Initialize= 1, Backlight= 2, Command= 3, Data= 4
+      };
+
       bool command(uint8_t cmd, Callback callback, void *callbackEnv)
       {
-        if((*master)())
+        if( isBusy() )
           return false;
     
-        context2= (void*)callback;
-        contextEnv= callbackEnv;
-
         orMask &= ~_BV(LCD_RS);
-    
-        return write(cmd, [](void *env)
+        start(Command, cmd, callback, callbackEnv);
+        return true;
+      }
+
+      void start(Job job_, uint8_t data_, Callback callback_, void *callbackEnv_)
+      {
+        job= job_;
+        data= data_;
+        callback= callback_;
+        callbackEnv= callbackEnv_;
+
+        co.restart();
+        resume();
+      }
+
+      // runs the job until its next await point. After the coroutine ended, the callbacks are called, they may start
+      // the next job.
+      void resume()
+      {
+        if( !run() )
+          return;
+
+        job= Idle;
+        uint8_t error= transaction.error();
+        if( error != 0 )
         {
-          LcdText *me= (LcdText*)env;
-          me->callbackDelay.start( 3, me, [](void *env)
-          {
-            LcdText *me= (LcdText*)env;
-            if(me->context2 != nullptr)
-              ((Callback)me->context2)( me->contextEnv );
-          });
-        });
+          if( errorReturn != nullptr )
+            errorReturn(error);
+        }
+        else if( callback != nullptr )
+        {
+          callback(callbackEnv);
+        }
       }
 
-      /*bool readBusy(BUSY_RETURN busyReturn)
+      // the coroutine of the running job, resumed until it returns true, it ends after a failed transaction
+      bool run()
       {
-        if((*master)())
-          return false;
-    
-        orMask &= ~_BV(LCD_RS);
-        writeData[0]= orMask | _BV(LCD_RW);
-        writeData[1]= orMask | _BV(LCD_BUSYFLAG) | _BV(LCD_RW) | _BV(LCD_ENABLE);
-        context= (void*)busyReturn;
-    
-        return master->startWriteAndRead(address, 2, writeData, 1, &readData, [](void *env, SABA::I2C::CMD* cmd)
+        SABA_CO_BEGIN(co);
+
+        if( job == Initialize )
         {
-          LcdText *me= (LcdText*)env;
-          if( cmd->error != 0 )
+          SABA_CO_AWAIT(co, transaction.write(address, 1, &orMask));
+          if( failed() )
+            SABA_CO_EXIT(co);
+
+          SABA_CO_DELAY(co, delay, 100);
+
+          // 8 bit mode three times, then 4 bit mode
+          for(step= 0;step < 4;step++)
           {
-            me->errorReturn(cmd->error);
+            nibble(step < 3 ? 0x30 : 0x20);
+            SABA_CO_AWAIT(co, transaction.write(address, 2, writeData));
+            if( failed() )
+              SABA_CO_EXIT(co);
+
+            if( step < 3 )
+              SABA_CO_DELAY(co, delay, step < 2 ? 5 : 1);
           }
-          else
+
+          // function set, display on, clear, entry mode
+          for(step= 0;step < 4;step++)
           {
-            cmd->bytesToWrite= 1;
-            cmd->bytesToRead= 0;
-            me->master->continueWriteAndRead([](void *env, SABA::I2C::CMD* cmd)
-            {
-              LcdText *me= (LcdText*)env;
-              if( cmd->error != 0 )
-                me->errorReturn(cmd->error);
-              else
-                ((BUSY_RETURN)me->context)(env, me->readData & _BV(LCD_BUSYFLAG));
-            } );
+            byte(step == 0 ? 0x28 | (DISPLAY_LINES ? 8 : 0) | (FONT ? 4 : 0) : step == 1 ? 0x0c : step == 2 ? 0x01 : 0x06);
+            SABA_CO_AWAIT(co, transaction.write(address, 4, writeData));
+            if( failed() )
+              SABA_CO_EXIT(co);
           }
-        }, (void *)this);
-      }*/
-  
-      bool writeNibble( uint8_t d, WRITE_RETURN writeReturn )
+
+          initialized= true;
+        }
+        else if( job == Backlight )
+        {
+          SABA_CO_AWAIT(co, transaction.write(address, 1, &orMask));
+          if( failed() )
+            SABA_CO_EXIT(co);
+        }
+        else
+        {
+          byte(data);
+          SABA_CO_AWAIT(co, transaction.write(address, 4, writeData));
+          if( failed() )
+            SABA_CO_EXIT(co);
+
+          if( job == Command )
+            SABA_CO_DELAY(co, delay, 3);
+        }
+
+        SABA_CO_END(co);
+      }
+
+      bool failed()
+      {
+        return transaction.error() != 0;
+      }
+
+      void nibble( uint8_t d )
       {
-        if( (*master)())
-          return false;
-    
         d &= 0xf0;
         d |= orMask;
     
@@ -304,27 +283,10 @@ namespace SABA
     #ifdef DEBUG_LCDTEXT_MESSAGE
       out << PSTR("N:") << writeData[0] << ' ' << writeData[1] << SABA::endl;
     #endif
-        context= (void*)writeReturn;
-
-        return master->startWrite(address, 2, writeData, [](void *env, SABA::I2C::CMD* cmd)
-        {
-          LcdText *me= (LcdText*)env;
-          if( cmd->error != 0 )
-          {
-            me->errorReturn(cmd->error);
-          }
-          else
-          {
-            ((WRITE_RETURN)me->context)(env);
-          }
-        }, (void *)this);
       }
   
-      bool write( uint8_t d, WRITE_RETURN writeReturn )
+      void byte( uint8_t d )
       {
-        if( (*master)())
-          return false;
-
         uint8_t tmp= (d & 0xf0) | orMask;
         writeData[0]= tmp | _BV(LCD_ENABLE);
         writeData[1]= tmp;
@@ -336,42 +298,26 @@ namespace SABA
     #ifdef DEBUG_LCDTEXT_MESSAGE
       out << PSTR("B:") << d << ' ' << writeData[0] << ' ' << writeData[1] << ' ' << writeData[2] << ' ' << writeData[3] << SABA::endl;
     #endif
-
-    
-        context= (void *)writeReturn;
-    
-        return master->startWrite(address, 4, writeData, [](void *env, SABA::I2C::CMD* cmd)
-        {
-          LcdText *me= (LcdText*)env;
-          if( cmd->error != 0 )
-          {
-            me->errorReturn(cmd->error);
-          }
-          else
-          {
-            ((WRITE_RETURN)me->context)(env);        
-          }
-        }, (void *)this);
       }
  
-      // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=60972
-      // https://gcc.gnu.org/bugzilla/show_bug.cgi?id=58798
-      SABA::I2C::I2CMaster *master;
+      SABA::I2C::Transaction transaction;
       uint8_t writeData[4];
 
       uint8_t address;
-      uint8_t readData;
       uint8_t orMask = 0;
       bool initialized= false;
+
+      uint8_t job= Idle;
+      uint8_t data= 0;   // the command or character of the running job
+      uint8_t step= 0;   // the loop counter of the initialization
   
-      void *context = nullptr;  // inner callback
-      void *context2= nullptr;  // public method callback - init, putch, ...
-      void *contextEnv= nullptr;
+      Callback callback= nullptr;
+      void *callbackEnv= nullptr;
 
       ERROR_RETURN errorReturn = nullptr;
   
-      SABA::Timing::CallbackDelay<uint8_t> callbackDelay;
-  
+      SABA::Coroutine co;
+      SABA::Timing::SingleDelay<uint8_t> delay;
     };
 
   }
@@ -85,6 +85,80 @@ namespace SABA
       virtual bool operator () () = 0;
     };
 
+    // \brief An I2C transaction, awaitable by a coroutine
+    /**
+    write() and writeAndRead() are called again until they return true: the first call starts the transaction,
+    if the master is idle, the last call returns true, if the transaction is done. error() tells the result.
+    2 bytes of RAM beside the master pointer, the buffers have to be kept until the transaction is done.
+
+    Usage:
+    ~~~{.c}
+    SABA_CO_AWAIT(co, transaction.write(0x4e, 2, data));
+    if( transaction.error() != 0 )
+      SABA_CO_EXIT(co);
+    ~~~
+    */
+    class Transaction
+    {
+    public:
+
+      Transaction(I2CMaster& master) : master(&master) { }
+
+      //! starts the write, if the master is idle, true if it is done
+      bool write(uint8_t address, uint8_t bytesToWrite, uint8_t *writeBuffer)
+      {
+        return writeAndRead(address, bytesToWrite, writeBuffer, 0, nullptr);
+      }
+
+      //! starts the write and read, if the master is idle, true if it is done
+      bool writeAndRead(uint8_t address, uint8_t bytesToWrite, uint8_t *writeBuffer, uint8_t bytesToRead, uint8_t *readBuffer)
+      {
+        if( state == Idle )
+        {
+          if( !master->startWriteAndRead(address, bytesToWrite, writeBuffer, bytesToRead, readBuffer, [](void *env, CMD* cmd)
+            {
+              Transaction *me= (Transaction*)env;
+              me->errorCode= cmd->error;
+              me->state= Done;
+            }, (void*)this) )
+            return false;
+
+          if( state == Idle )
+            state= Started;
+        }
+
+        if( state == Started )
+          (*master)();
+
+        if( state != Done )
+          return false;
+
+        state= Idle;
+        return true;
+      }
+
+      uint8_t error() //! the TWI status of the failed transaction, 0 if it was successful
+      {
+        return errorCode;
+      }
+
+      I2CMaster& getMaster()
+      {
+        return *master;
+      }
+
+    private:
+
+      enum State
+      {
+        Idle= 0, Started= 1, Done= 2
+      };
+
+      I2CMaster *master;
+      volatile uint8_t state= Idle;
+      uint8_t errorCode= 0;
+    };
+
     template<SFRA TWBR_,SFRA TWSR_,SFRA TWAR_,SFRA TWDR_,SFRA TWCR_,SFRA TWAMR_>
     class Master : public I2CMaster
     {
@@ -276,4 +350,4 @@ namespace SABA
 }
 
 
-#endif /* SABA_I2CM_H_ */
\ No newline at end of file
+#endif /* SABA_I2CM_H_ */
\ No newline at end of file
@@ -0,0 +1,189 @@
+/*
+ * saba_log.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Deferred binary logging, the text is composed on the host by tools/saba_log_decode.py
+ */
+
+#ifndef SABA_LOG_H_
+#define SABA_LOG_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#include <saba_fifo.h>
+#include <saba_format.h>
+
+/** store a log record in a DeferredLog
+ * The format string uses the placeholders of SABA_FORMAT. It is stored in FLASH together with the argument types,
+ * its address is the 16 bit ID of the call site. The record is the ID followed by the raw argument bytes, little
+ * endian. {} and {:d} are decoded as decimal, {:x} as hexadecimal, {:c} as char. FLASH strings can not be logged.
+ *
+ * Usage:
+ * ~~~{.c}
+ * SABA_LOG(log, "TCNT{}: {:x} overflow {}", '1', TCNT1, count);
+ * ~~~
+ */
+#define SABA_LOG(LOG, FORMAT, ...)                                                  \
+  do                                                                                \
+  {                                                                                 \
+    struct SabaLogString                                                            \
+    {                                                                               \
+      static constexpr const char *str() { return FORMAT; }                         \
+    };                                                                              \
+    SABA::Log::record<SabaLogString>(LOG, ##__VA_ARGS__);                           \
+  }                                                                                 \
+  while(0)
+
+namespace SABA
+{
+  /**
+   @namespace SABA::Log
+   @brief The FLASH log table used by SABA_LOG
+  */
+  namespace Log
+  {
+    //! the argument type codes of the log table, the same as the Python struct module
+    template<typename T> struct Code { static constexpr char value = 0; };
+    template<> struct Code<uint8_t> { static constexpr char value = 'B'; };
+    template<> struct Code<int8_t> { static constexpr char value = 'b'; };
+    template<> struct Code<uint16_t> { static constexpr char value = 'H'; };
+    template<> struct Code<int16_t> { static constexpr char value = 'h'; };
+    template<> struct Code<uint32_t> { static constexpr char value = 'I'; };
+    template<> struct Code<int32_t> { static constexpr char value = 'i'; };
+    template<> struct Code<char> { static constexpr char value = 'c'; };
+    template<> struct Code<bool> { static constexpr char value = '?'; };
+
+    //! the number of argument bytes of a record
+    template<typename... ARGS> struct Size;
+    template<> struct Size<> { static constexpr uint8_t value = 0; };
+    template<typename T, typename... REST> struct Size<T, REST...>
+    {
+      static constexpr uint8_t value = sizeof(T) + Size<REST...>::value;
+    };
+
+    //! checks the argument types of the placeholders, starting at INDEX
+    template<class FORMAT, uint8_t INDEX, typename... ARGS> struct Check;
+    template<class FORMAT, uint8_t INDEX> struct Check<FORMAT, INDEX> { static constexpr bool value = true; };
+    template<class FORMAT, uint8_t INDEX, typename T, typename... REST> struct Check<FORMAT, INDEX, T, REST...>
+    {
+      static constexpr bool value = Code<T>::value != 0 && Format::accepts(Format::spec(FORMAT::str(), INDEX), Format::Category<T>::value)
+        && Check<FORMAT, INDEX + 1, REST...>::value;
+    };
+
+    //! the table entry of a call site: the format string, a 0, the argument type codes and a 0
+    template<class FORMAT, class INDICES, typename... ARGS> struct Entry;
+    template<class FORMAT, uint16_t... I, typename... ARGS> struct Entry<FORMAT, Format::Indices<I...>, ARGS...>
+    {
+      static const char str[sizeof...(I) + sizeof...(ARGS) + 2] PROGMEM;
+    };
+
+    template<class FORMAT, uint16_t... I, typename... ARGS>
+    const char Entry<FORMAT, Format::Indices<I...>, ARGS...>::str[sizeof...(I) + sizeof...(ARGS) + 2] PROGMEM =
+      { FORMAT::str()[I]..., 0, Code<ARGS>::value..., 0 };
+
+    //! used by SABA_LOG
+    template<class FORMAT, class LOG, typename... ARGS> void record(LOG& log, ARGS... args)
+    {
+      static_assert(Format::balanced(FORMAT::str()), "log placeholder not closed");
+      static_assert(Format::count(FORMAT::str()) == sizeof...(ARGS), "log placeholder count does not match the argument count");
+      static_assert(Check<FORMAT, 0, ARGS...>::value, "log placeholder does not accept the argument type");
+
+      typedef Entry<FORMAT, typename Format::MakeIndices<Format::length(FORMAT::str())>::type, ARGS...> LogEntry;
+
+      log.push(uint16_t(uintptr_t(LogEntry::str)), Size<ARGS...>::value, args...);
+    }
+  }
+
+  // \brief A ring buffer of binary log records
+  /**
+  SABA_LOG stores the records, drain() writes them to the putch function, e.g. from the main loop. A record is dropped
+  as a whole, if it does not fit into the buffer, so the byte stream stays decodable. The records are stored by one
+  producer, either the main loop or an ISR, like SpscFifo.
+  The host tool tools/saba_log_decode.py reads the format strings from the ELF file and prints the text.
+  @tparam putch The putch function receiving the records
+  @tparam SIZE the buffer size, a power of two up to 128
+
+  Usage:
+  ~~~{.c}
+  SABA::DeferredLog<&putch,64> log;
+
+  SABA_LOG(log, "adc {}: {}", channel, value);
+
+  for(;;)
+  {
+    log.drain(8);
+  }
+  ~~~
+  */
+  template<PUTCH putch, uint8_t SIZE>
+  class DeferredLog
+  {
+    static_assert(SIZE != 0 && (SIZE & (SIZE - 1)) == 0, "DeferredLog size must be a power of two");
+    static_assert(SIZE <= 128, "DeferredLog size must be <= 128");
+
+    public:
+
+    template<typename... ARGS> void push(uint16_t id, uint8_t size, ARGS... args) //! stores a record, used by SABA_LOG
+    {
+      uint8_t wi= writeIndex;
+      if( SIZE - uint8_t(wi - readIndex) < size + 2 )
+      {
+        ++dropCount;
+        return;
+      }
+
+      // the bytes are written directly, the record is published by a single index update
+      store(wi, id, args...);
+      SABA_MEMORY_BARRIER();
+      writeIndex= wi;
+    }
+
+    void drain(uint8_t count = SIZE) //! writes up to count bytes to the putch function
+    {
+      uint8_t ri= readIndex;
+      uint8_t wi= writeIndex;
+      SABA_MEMORY_BARRIER();
+
+      for(;count != 0 && ri != wi;count--)
+        putch(buffer[ri++ & MASK]);
+
+      SABA_MEMORY_BARRIER();
+      readIndex= ri;
+    }
+
+    uint8_t drops() //! the number of records dropped, because the buffer was full
+    {
+      return dropCount;
+    }
+
+    private:
+
+    static constexpr uint8_t MASK = SIZE - 1;
+
+    void store(uint8_t& /*wi*/)
+    {
+    }
+
+    // the AVR and the record are little endian, the bytes of the value are copied
+    template<typename T, typename... REST> void store(uint8_t& wi, T value, REST... rest)
+    {
+      const uint8_t *p= (const uint8_t *)&value;
+      for(uint8_t i=0;i < sizeof(T);i++)
+        buffer[wi++ & MASK]= p[i];
+
+      store(wi, rest...);
+    }
+
+    uint8_t buffer[SIZE];
+    volatile uint8_t writeIndex = 0;
+    volatile uint8_t readIndex = 0;
+    uint8_t dropCount = 0;
+  };
+}
+
+#endif // SABA_LOG_H_
@@ -17,20 +17,57 @@
 #include <saba_avr.h>
 #include <saba_ostream.h>
 #include <saba_cmdline.h>
+#include <saba_fifo.h>
+#include <saba_hexdump.h>
+#include <saba_timing.h>
 
 namespace SABA
 {
+  // evaluates x up to three times, pass a variable
   #define LOWER_CASE(x)       (((x) >= 'A' && (x) <= 'Z') ? ((x) + 0x20) : (x))
 
-  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, template<PUTCH putch> class OSTREAM, PUTCH putch>
+  //! the data space and FLASH access of the Monitor, the MEMORY of a host test simulates it
+  struct DataSpace
+  {
+    static uint8_t read(uint16_t address)
+    {
+      return *(volatile uint8_t *)uintptr_t(address);
+    }
+
+    static void write(uint16_t address, uint8_t value)
+    {
+      *(volatile uint8_t *)uintptr_t(address)= value;
+    }
+
+    static uint8_t readFlash(uint16_t address)
+    {
+      return pgm_read_byte((const uint8_t *)uintptr_t(address));
+    }
+
+    static uint16_t read16(uint16_t address) //! with interrupts disabled, a value changed by an ISR is not torn
+    {
+      uint8_t sreg= SREG;
+      cli();
+      uint16_t value= *(volatile uint16_t *)uintptr_t(address);
+      SREG= sreg;
+
+      return value;
+    }
+  };
+
+  // WATCH_SIZE is the number of addresses the watch command can observe, MEMORY accesses the data space and FLASH
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, template<PUTCH putch> class OSTREAM, PUTCH putch, uint8_t WATCH_SIZE = 4, class MEMORY = DataSpace>
   class Monitor
   {
   public:
 
+    //! binary result: PIN, DDR and PORT of the port, binary mode needs the port letter, it returns one port only
     static bool ports(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {      
       char ch= cmdReader.nextCharIgnoreBlank();
       ch= LOWER_CASE( ch );
+      if( ch == 0 && cmdReader.binary() )
+        return false;
 
       uint8_t b= 0;
       char mode= cmdReader.nextCharIgnoreBlank();
@@ -72,75 +109,84 @@ namespace SABA
       if( ch == 'a' )
         modifyPort<(SFRA)&PINA>(mode, b);
       if( ch == 0 || ch == 'a' )
-        dumpPort<(SFRA)&PINA>('A');
+        dumpPort<(SFRA)&PINA>(cmdReader, 'A');
 #endif
 #if defined(PORTB) && defined(PINB) && defined (DDRB)
       if( ch == 'b' )
         modifyPort<(SFRA)&PINB>(mode, b);
       if( ch == 0 || ch == 'b' )
-        dumpPort<(SFRA)&PINB>('B');
+        dumpPort<(SFRA)&PINB>(cmdReader, 'B');
 #endif
 #if defined(PORTC) && defined(PINC) && defined (DDRC)
       if( ch == 'c' )
         modifyPort<(SFRA)&PINC>(mode, b);
       if( ch == 0 || ch == 'c' )
-        dumpPort<(SFRA)&PINC>('C');
+        dumpPort<(SFRA)&PINC>(cmdReader, 'C');
 #endif
 #if defined(PORTD) && defined(PIND) && defined (DDRD)
       if( ch == 'd' )
         modifyPort<(SFRA)&PIND>(mode, b);
       if( ch == 0 || ch == 'd' )
-        dumpPort<(SFRA)&PIND>('D');
+        dumpPort<(SFRA)&PIND>(cmdReader, 'D');
 #endif
 #if defined(PORTE) && defined(PINE) && defined (DDRE)
       if( ch == 'e' )
         modifyPort<(SFRA)&PINE>(mode, b);
       if( ch == 0 || ch == 'e' )
-        dumpPort<(SFRA)&PINE>('E');
+        dumpPort<(SFRA)&PINE>(cmdReader, 'E');
 #endif
 #if defined(PORTF) && defined(PINF) && defined (DDRF)
       if( ch == 'f' )
         modifyPort<(SFRA)&PINF>(mode, b);
       if( ch == 0 || ch == 'f' )
-        dumpPort<(SFRA)&PINF>('F');
+        dumpPort<(SFRA)&PINF>(cmdReader, 'F');
 #endif
 #if defined(PORTG) && defined(PING) && defined (DDRG)
       if( ch == 'g' )
         modifyPort<(SFRA)&PING>(mode, b);
       if( ch == 0 || ch == 'g' )
-        dumpPort<(SFRA)&PING>('G');
+        dumpPort<(SFRA)&PING>(cmdReader, 'G');
 #endif
 #if defined(PORTH) && defined(PINH) && defined (DDRH)
       if( ch == 'b' )
         modifyPort<(SFRA)&PINH>(mode, b);
       if( ch == 0 || ch == 'h' )
-        dumpPort<(SFRA)&PINH>('H');
+        dumpPort<(SFRA)&PINH>(cmdReader, 'H');
 #endif
 #if defined(PORTJ) && defined(PINJ) && defined (DDRJ)
       if( ch == 'j' )
         modifyPort<(SFRA)&PINJ>(mode, b);
       if( ch == 0 || ch == 'j' )
-        dumpPort<(SFRA)&PINJ>('J');
+        dumpPort<(SFRA)&PINJ>(cmdReader, 'J');
 #endif
 #if defined(PORTK) && defined(PINK) && defined (DDRK)
       if( ch == 'k' )
         modifyPort<(SFRA)&PINK>(mode, b);
       if( ch == 0 || ch == 'k' )
-        dumpPort<(SFRA)&PINK>('K');
+        dumpPort<(SFRA)&PINK>(cmdReader, 'K');
 #endif
 #if defined(PORTL) && defined(PINL) && defined (DDRL)
       if( ch == 'l' )
         modifyPort<(SFRA)&PINL>(mode, b);
       if( ch == 0 || ch == 'l' )
-        dumpPort<(SFRA)&PINL>('L');
+        dumpPort<(SFRA)&PINL>(cmdReader, 'L');
 #endif
 
       return true;
     }
 
 
+    //! binary result: ADMUX, ADCSRA, ADC
     static bool adc(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {
+      if( cmdReader.binary() )
+      {
+        cmdReader.result(ADMUX);
+        cmdReader.result(ADCSRA);
+        cmdReader.result(ADC);
+        return true;
+      }
+
       OStream<putch> ostr;
 
       ostr << PSTR("ADMUX:  ") << hex << ADMUX << endl
@@ -150,8 +196,16 @@ namespace SABA
       return true;
     }
 
+    //! binary result: SPCR, SPSR
     static bool spi(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {
+      if( cmdReader.binary() )
+      {
+        cmdReader.result(SPCR);
+        cmdReader.result(SPSR);
+        return true;
+      }
+
       OStream<putch> ostr;
 
       ostr << PSTR("SPCR: ") << hex << SPCR << endl
@@ -160,8 +214,16 @@ namespace SABA
       return true;
     }
 
+    //! binary result: OSCCAL, CLKPR
     static bool clock(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {
+      if( cmdReader.binary() )
+      {
+        cmdReader.result(OSCCAL);
+        cmdReader.result(CLKPR);
+        return true;
+      }
+
       OStream<putch> ostr;
 
       ostr << PSTR("OSCAL: ") << hex << OSCCAL << PSTR(" CLKPR: ") << CLKPR << endl;
@@ -171,7 +233,7 @@ namespace SABA
     
     static bool eeprom(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {
-      uint16_t start= cmdReader.template nextHex<uint8_t>();
+      uint16_t start= cmdReader.template nextHex<uint16_t>();
       uint8_t rows;
       if( !cmdReader() )
         return false;
@@ -184,21 +246,246 @@ namespace SABA
         rows= 1;
   
       OStream<putch> ostr;
-      ostr << hex;
-      for( ;rows > 0;rows--)
+      hexdump(ostr, EepromReader(), start, uint16_t(rows) * HEXDUMP_ROW);
+
+      return true;
+    }
+
+    static bool fifos(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      OStream<putch> ostr;
+      ostr << dec;
+
+      for(FifoStatistics<true> *fifo= FifoStatistics<true>::first();fifo != nullptr;fifo= fifo->next())
+      {
+        ostr << fifo->name()
+          << PSTR(" size: ") << fifo->size()
+          << PSTR(" high: ") << fifo->highWater()
+          << PSTR(" failed: ") << fifo->pushFailures()
+          << PSTR(" pushed: ") << fifo->pushCount() << endl;
+      }
+
+      return true;
+    }
+
+    //! d|f address [count]: hex dump of the data space (registers, I/O, extended I/O and SRAM) or the FLASH, binary result: the bytes, max CMD_RESULT_SIZE
+    static bool peek(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      char space= cmdReader.nextCharIgnoreBlank();
+      space= LOWER_CASE( space );
+      uint16_t address= cmdReader.template nextHex<uint16_t>();
+      if( !cmdReader() || (space != 'd' && space != 'f') )
+        return false;
+
+      uint16_t count= cmdReader.template nextHex<uint16_t>();
+      if( !cmdReader() )
+        count= 1;
+
+      if( cmdReader.binary() )
+      {
+        if( count > CMD_RESULT_SIZE )
+          return false;
+
+        for(uint8_t i=0;i < count;i++)
+          cmdReader.result(space == 'd' ? MEMORY::read(address + i) : MEMORY::readFlash(address + i));
+        return true;
+      }
+
+      OStream<putch> ostr;
+      if( space == 'd' )
+        hexdump(ostr, DataReader(), address, count);
+      else
+        hexdump(ostr, FlashReader(), address, count);
+
+      return true;
+    }
+
+    //! address value [value ...]: writes bytes into the data space, starting at address, no binary result
+    static bool poke(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      uint16_t address= cmdReader.template nextHex<uint16_t>();
+      uint8_t value= cmdReader.template nextHex<uint8_t>();
+      if( !cmdReader() )
+        return false;
+
+      do
+      {
+        MEMORY::write(address++, value);
+        value= cmdReader.template nextHex<uint8_t>();
+      }
+      while( cmdReader() );
+
+      return true;
+    }
+
+    //! d|f address count [h]: streams count bytes of the data space or FLASH as raw binary, or as hex digits without separators with h
+    static bool block(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      char space= cmdReader.nextCharIgnoreBlank();
+      space= LOWER_CASE( space );
+      uint16_t address= cmdReader.template nextHex<uint16_t>();
+      uint16_t count= cmdReader.template nextHex<uint16_t>();
+      if( !cmdReader() || (space != 'd' && space != 'f') )
+        return false;
+
+      char mode= cmdReader.nextCharIgnoreBlank();
+      bool hexMode= LOWER_CASE( mode ) == 'h';
+
+      for(;count != 0;count--,address++)
       {
-        ostr <<  start << ':';
-        for(uint8_t i=16;i != 0;i--)
+        uint8_t b= space == 'd' ? MEMORY::read(address) : MEMORY::readFlash(address);
+        if( hexMode )
+        {
+          putch( pgm_read_byte(HEX_DIGITS + (b >> 4)) );
+          putch( pgm_read_byte(HEX_DIGITS + (b & 0xf)) );
+        }
+        else
         {
-          ostr << ' ' << eeprom_read_byte( (const uint8_t *)start );
-          start++;
+          putch( b );
         }
+      }
+
+      if( hexMode )
+      {
+        OStream<putch> ostr;
         ostr << endl;
       }
 
       return true;
     }
 
+    //! + address [1|2]: watch an 8 or 16 bit value, - [address]: remove one or all, p ticks: the sample period, 0 stops
+    static bool watch(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      char ch= cmdReader.nextCharIgnoreBlank();
+      uint16_t address= cmdReader.template nextHex<uint16_t>();
+      bool hasAddress= cmdReader();
+
+      if( ch == '+' )
+      {
+        if( !hasAddress )
+          return false;
+
+        uint8_t size= cmdReader.template nextHex<uint8_t>();
+        if( !cmdReader() )
+          size= 1;
+        if( size != 1 && size != 2 )
+          return false;
+
+        WatchEntry *entry= findWatch(address);
+        if( entry == nullptr )
+          entry= freeWatch();
+        if( entry == nullptr )
+          return false;
+
+        entry->address= address;
+        entry->size= size;
+        entry->changed= true;
+      }
+      else if( ch == '-' )
+      {
+        for(uint8_t i=0;i < WATCH_SIZE;i++)
+          if( !hasAddress || watches[i].address == address )
+            watches[i].size= 0;
+      }
+      else if( LOWER_CASE(ch) == 'p' )
+      {
+        if( !hasAddress )
+          return false;
+
+        watchPeriod= address;
+        watchStart= Timing::now16();
+        for(uint8_t i=0;i < WATCH_SIZE;i++)
+          watches[i].changed= true;
+      }
+      else if( ch != 0 )
+      {
+        return false;
+      }
+
+      OStream<putch> ostr;
+      ostr << PSTR("period: ") << hex << watchPeriod;
+      for(uint8_t i=0;i < WATCH_SIZE;i++)
+        if( watches[i].size != 0 )
+          ostr << ' ' << watches[i].address << ':' << watches[i].size;
+      ostr << endl;
+
+      return true;
+    }
+
+    /** samples the watched values every period ticks, call it from the main loop
+     * Only the changed values are printed in one line, "~AAAA:VV AAAA:VVVV", nothing if none changed.
+     * After adding an address or setting the period all values are printed once.
+     */
+    static void watchPoll()
+    {
+      if( watchPeriod == 0 || uint16_t(Timing::now16() - watchStart) < watchPeriod )
+        return;
+
+      watchStart += watchPeriod;
+
+      OStream<putch> ostr;
+      bool first= true;
+      for(uint8_t i=0;i < WATCH_SIZE;i++)
+      {
+        WatchEntry& entry= watches[i];
+        if( entry.size == 0 )
+          continue;
+
+        uint16_t value= entry.size == 1 ? MEMORY::read(entry.address) : MEMORY::read16(entry.address);
+        if( value == entry.value && !entry.changed )
+          continue;
+
+        entry.value= value;
+        entry.changed= false;
+
+        ostr << (first ? '~' : ' ') << hex << entry.address << ':';
+        if( entry.size == 1 )
+          ostr << uint8_t(value);
+        else
+          ostr << value;
+        first= false;
+      }
+
+      if( !first )
+        ostr << endl;
+    }
+
+    //! [r]: print the statistics of a LoopProfiler in timer counts, r resets them
+    template<class PROFILER> static bool profile(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
+    {
+      char ch= cmdReader.nextCharIgnoreBlank();
+      ch= LOWER_CASE( ch );
+      if( ch == 'r' )
+      {
+        PROFILER::reset();
+        return true;
+      }
+      if( ch != 0 )
+        return false;
+
+      // binary result: minimum, average, maximum, 16 bit, loops per second, 32 bit
+      if( cmdReader.binary() )
+      {
+        cmdReader.result(PROFILER::minimum());
+        cmdReader.result(PROFILER::average());
+        cmdReader.result(PROFILER::maximum());
+        cmdReader.result(PROFILER::perSecond());
+        return true;
+      }
+
+      OStream<putch> ostr;
+      ostr << dec << PSTR("min: ") << PROFILER::minimum() << PSTR(" avg: ") << PROFILER::average()
+        << PSTR(" max: ") << PROFILER::maximum() << PSTR(" loops/s: ") << PROFILER::perSecond() << endl;
+
+      // the bucket i counts the iterations up to 2^i - 1 timer counts, empty buckets are skipped
+      for(uint8_t i=0;i < PROFILER::BUCKETS;i++)
+        if( PROFILER::bucketCount(i) != 0 )
+          ostr << '<' << uint32_t(1UL << i) << ':' << ' ' << PROFILER::bucketCount(i) << endl;
+
+      return true;
+    }
+
     static bool timer(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader)
     {
       char ch= cmdReader.nextCharIgnoreBlank();
@@ -269,6 +556,53 @@ namespace SABA
     }
 
   protected:
+    struct WatchEntry
+    {
+      uint16_t address;
+      uint16_t value;
+      uint8_t size;       // 1 or 2, 0 if unused
+      bool changed;       // print on the next sample, even if the value is the same
+    };
+
+    // the hexdump sources of peek
+    struct DataReader
+    {
+      uint8_t operator()(uint16_t address) const
+      {
+        return MEMORY::read(address);
+      }
+    };
+
+    struct FlashReader
+    {
+      uint8_t operator()(uint16_t address) const
+      {
+        return MEMORY::readFlash(address);
+      }
+    };
+
+    static WatchEntry *findWatch(uint16_t address)
+    {
+      for(uint8_t i=0;i < WATCH_SIZE;i++)
+        if( watches[i].size != 0 && watches[i].address == address )
+          return watches + i;
+
+      return nullptr;
+    }
+
+    static WatchEntry *freeWatch()
+    {
+      for(uint8_t i=0;i < WATCH_SIZE;i++)
+        if( watches[i].size == 0 )
+          return watches + i;
+
+      return nullptr;
+    }
+
+    static WatchEntry watches[WATCH_SIZE];
+    static uint16_t watchPeriod;
+    static uint16_t watchStart;
+
     static constexpr uint8_t MODE_SETBIT = 1;
     static constexpr uint8_t MODE_RESET = 2;
     static constexpr uint8_t MODE_TOGGLE = 3;
@@ -301,11 +635,20 @@ namespace SABA
       }
     }
 
-    template<SFRA PIN_ADDR> static void dumpPort(char pch)
+    template<SFRA PIN_ADDR> static void dumpPort(CmdReader<INDEX_TYPE,BUFFER_SIZE>& cmdReader, char pch)
     {
-      OStream<putch> ostr;
       Port8<PIN_ADDR> port8;
 
+      if( cmdReader.binary() )
+      {
+        cmdReader.result(port8.pin());
+        cmdReader.result(port8.ddr());
+        cmdReader.result(port8.port());
+        return;
+      }
+
+      OStream<putch> ostr;
+
       ostr << PSTR("PIN") << pch << hex << ':' << port8.pin()
         << PSTR(" DDR") << pch << ':' << port8.ddr()
         << PSTR(" PORT") << pch << ':' << port8.port()
@@ -345,6 +688,15 @@ namespace SABA
     }
   };
 
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, template<PUTCH putch> class OSTREAM, PUTCH putch, uint8_t WATCH_SIZE, class MEMORY>
+  typename Monitor<INDEX_TYPE,BUFFER_SIZE,OSTREAM,putch,WATCH_SIZE,MEMORY>::WatchEntry Monitor<INDEX_TYPE,BUFFER_SIZE,OSTREAM,putch,WATCH_SIZE,MEMORY>::watches[WATCH_SIZE];
+
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, template<PUTCH putch> class OSTREAM, PUTCH putch, uint8_t WATCH_SIZE, class MEMORY>
+  uint16_t Monitor<INDEX_TYPE,BUFFER_SIZE,OSTREAM,putch,WATCH_SIZE,MEMORY>::watchPeriod;
+
+  template<typename INDEX_TYPE,INDEX_TYPE BUFFER_SIZE, template<PUTCH putch> class OSTREAM, PUTCH putch, uint8_t WATCH_SIZE, class MEMORY>
+  uint16_t Monitor<INDEX_TYPE,BUFFER_SIZE,OSTREAM,putch,WATCH_SIZE,MEMORY>::watchStart;
+
 }
 
 #endif // SABA_MONITOR_H_
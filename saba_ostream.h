@@ -6,7 +6,7 @@
  * Created: 12.10.2017 
  * Author: Joerg
  *
- * std::ostream compatible class need a PUCH function as output
+ * std::ostream compatible class need a PUCH function or a RAM buffer as output
  */ 
 
 #ifndef SABA_OSTREAM_H_
@@ -20,6 +20,13 @@ namespace SABA
   //! the putch function needed for output
   typedef void (*PUTCH)(uint8_t);
 
+  //! the block output function needed for buffered output
+  typedef void (*PUTBLOCK)(const uint8_t *data, uint8_t length);
+
+  //! powers of ten for the division free decimal output
+  const uint32_t DEC_POWERS32[] PROGMEM = { 1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10 };
+  const uint16_t DEC_POWERS16[] PROGMEM = { 10000, 1000, 100, 10 };
+
   // \brief C++ output stream super class
   /** 
   The SABA::ios_base is a similar super class to std::out
@@ -63,71 +70,102 @@ namespace SABA
       
       return tmp;
     }
+
+    //! set the number of decimal places of Fixed values, max 4
+    uint8_t precision(uint8_t newPrecision)
+    {
+      uint8_t tmp= fprecision;
+      fprecision= newPrecision > 4 ? 4 : newPrecision;
+
+      return tmp;
+    }
         
     protected:
     _Fmtflags fmtflags= 0;
     uint8_t fwidth = 0;
+    uint8_t fprecision = 2;
   };
 
-  // \brief A C++ output stream class
+  //! the storage type of a Fixed value
+  template<bool SHORT> struct FixedType { typedef int32_t type; };
+  template<> struct FixedType<true> { typedef int16_t type; };
+
+  // \brief A signed binary fixed point number
   /** 
-  This class is used to output text similar to std::ostream.
-  @tparam PUTCH The putch function receiving the output
+  Used to serialize a fixed point value with OStream. The number of decimal places is set by precision(), the
+  last place is rounded to even like printf.
+  @tparam INT_BITS the number of integer bits including the sign
+  @tparam FRAC_BITS the number of fractional bits, max 16
 
   Usage:
   ~~~{.c}
-  // the OStream putch method redirects output to the Usart
-  void putch(uint8_t c)
+  int16_t temperature= 0x1980;  // Q8.8 from the sensor
+
+  out.precision(1);
+  out << SABA::Fixed<8,8>(temperature) << SABA::endl;  // 25.5
+  ~~~ 
+  */
+  template<uint8_t INT_BITS, uint8_t FRAC_BITS>
+  struct Fixed
   {
-    usart.putch(c);
-  }
+    static_assert(INT_BITS + FRAC_BITS <= 32, "Fixed is limited to 32 bits");
+    static_assert(FRAC_BITS <= 16, "Fixed is limited to 16 fractional bits");
 
-  SABA::OStream <&putch> out;
+    typedef typename FixedType<INT_BITS + FRAC_BITS <= 16>::type type;
 
-  out << PSTR("Hello World!") << SABA::endl;
-  out << PSTR("The answer to everything is:") <<  SABA::dec << 42 << SABA::endl;
-  ~~~ 
+    explicit Fixed(type raw) : value(raw)
+    {
+    }
+
+    type value; //! the raw value, scaled by 2^FRAC_BITS
+  };
+
+  // \brief The formatting and serializing part of the output streams
+  /** 
+  Implements the operators << of OStream and OStringStream. The derived class STREAM writes the characters
+  with its putch(uint8_t) method.
+  @tparam STREAM The derived stream class
   */
-  template<PUTCH putch>
-  class OStream : public ios_base
+  template<class STREAM>
+  class BasicOStream : public ios_base
   {
     public:
 
-    OStream& operator << (char c) //! serializes a single char
+    BasicOStream& operator << (char c) //! serializes a single char
     {
-      putch(c);
+      put(c);
 
       return *this;
     }
 
-    OStream& print(const char *str)
+    BasicOStream& print(const char *str)
     {
       while(*str)
-        putch(*str++);
+        put(*str++);
 
       return *this;
     }
 
-    OStream& operator << (const /*PROGMEM*/ char *str) //! serializes a string, use PSTR("xxx") as a string stored in FLASH
+    BasicOStream& operator << (const /*PROGMEM*/ char *str) //! serializes a string, use PSTR("xxx") as a string stored in FLASH
     {
       uint8_t ch;
       while((ch= pgm_read_byte(str++)) != 0)
-        putch(ch);
+        put(ch);
 
       return *this;
     }
 
-    OStream& operator<<(OStream& (*pfn)(OStream&))
+    BasicOStream& operator<<(BasicOStream& (*pfn)(BasicOStream&))
     {
       return ((*pfn)(*this));
     }
 
-    OStream& operator<<(OStream& (*pfn)(OStream&,int))
+    BasicOStream& operator<<(BasicOStream& (*pfn)(BasicOStream&,int))
     {
       return ((*pfn)(*this));
     }
 
-    OStream& operator<<( bool b ) //! serializes a bool value as 'true' or 'false'
+    BasicOStream& operator<<( bool b ) //! serializes a bool value as 'true' or 'false'
     {
       uint8_t fsize= 0;
       if( fwidth != 0 )
@@ -147,7 +185,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( uint8_t i ) //! serializes an 8 bit unsigned integer
+    BasicOStream& operator<<( uint8_t i ) //! serializes an 8 bit unsigned integer
     {
       if( (fmtflags & base) == hex )
       {
@@ -167,7 +205,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( int8_t i ) //! serializes an 8 bit signed integer
+    BasicOStream& operator<<( int8_t i ) //! serializes an 8 bit signed integer
     {
       if( (fmtflags & base) == hex )
         this->operator <<(uint8_t(i));
@@ -177,7 +215,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( uint16_t i )  //! serializes an 16 bit unsigned integer
+    BasicOStream& operator<<( uint16_t i )  //! serializes an 16 bit unsigned integer
     {
       if( (fmtflags & base) == hex )
       {
@@ -197,7 +235,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( int16_t i ) //! serializes an 16 bit signed integer
+    BasicOStream& operator<<( int16_t i ) //! serializes an 16 bit signed integer
     {
       if( (fmtflags & base) == hex )
         this->operator <<(uint16_t(i));
@@ -207,7 +245,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( uint32_t i ) //! serializes an 32 bit unsigned integer
+    BasicOStream& operator<<( uint32_t i ) //! serializes an 32 bit unsigned integer
     {
       if( (fmtflags & base) == hex )
       {
@@ -226,7 +264,7 @@ namespace SABA
       return *this;
     }
 
-    OStream& operator<<( int32_t i ) //! serializes an 32 bit signed integer
+    BasicOStream& operator<<( int32_t i ) //! serializes an 32 bit signed integer
     {
       if( (fmtflags & base) == hex )
         this->operator <<(uint32_t(i));
@@ -236,13 +274,26 @@ namespace SABA
       return *this;
     }
 
+    template<uint8_t INT_BITS, uint8_t FRAC_BITS>
+    BasicOStream& operator<<( Fixed<INT_BITS,FRAC_BITS> f ) //! serializes a fixed point value with precision() decimal places
+    {
+      printFixed( int32_t(f.value), FRAC_BITS );
+
+      return *this;
+    }
+
 
     private:
 
+    void put(uint8_t c)
+    {
+      static_cast<STREAM*>(this)->putch(c);
+    }
+
     void printFill(uint8_t count)
     {
       for(;count != 0;count--)
-        putch(' ');
+        put(' ');
     }
     
     void printHex(uint8_t c) /*const*/
@@ -270,7 +321,7 @@ namespace SABA
       if(c > '9')
         c += 'A' - '9' -1;
 
-      putch( (char) c );
+      put( (char) c );
     }
 
     void printDec(uint8_t b, bool signedInt = false)
@@ -301,23 +352,23 @@ namespace SABA
         printFill(fwidth - fsize);
         
       if( printMinus )
-        putch('-');
+        put('-');
 
       bool p= false;
       if( b >= 100 )
       {
-        putch( '0' + ( b / 100 ) );
+        put( '0' + ( b / 100 ) );
         b %= 100;
         p= true;
       }
 
       if( p || b >= 10 )
       {
-        putch( '0' + (b / 10) );
+        put( '0' + (b / 10) );
         b %= 10;
       }
 
-      putch( '0' + b );
+      put( '0' + b );
       
       if( (fmtflags & ios_base::adjust) == ios_base::left && fwidth > fsize)
         printFill(fwidth - fsize);
@@ -325,29 +376,20 @@ namespace SABA
 
     void printDec(uint16_t w, bool signedInt = false) /*const*/
     {
-      bool p= false;
       bool printMinus= false;
-      uint16_t div= 10000;
       uint8_t fsize= 0;
 
       if( signedInt && int16_t(w) < 0)
       {
         printMinus= true;
-        w= uint16_t(- int16_t(w));
+        w= uint16_t(0 - w);
       }
 
       if( fwidth != 0 )
       {
-        if(w >= 10000)
-          fsize= 5;
-        else if(w >= 1000)
-          fsize= 4;
-        else if(w >= 100)
-          fsize= 3;
-        else if(w >= 10)
-          fsize= 2;
-        else
-          fsize= 1;
+        fsize= 5;
+        for(uint8_t i=0;i < 4 && w < pgm_read_word(&DEC_POWERS16[i]);i++)
+          --fsize;
 
         if( printMinus )
           ++fsize;
@@ -357,17 +399,9 @@ namespace SABA
         printFill(fwidth - fsize);
 
       if( printMinus )
-        putch('-');
+        put('-');
 
-      for(;div > 0; div /= 10)
-      {
-        if( p || div == 1 || w >= div)
-        {
-          putch( '0' + ( w / div ) );
-          w %= div;
-          p= true;
-        }
-      }
+      printDigits(w);
       
       if( (fmtflags & ios_base::adjust) == ios_base::left && fwidth > fsize)
         printFill(fwidth - fsize);
@@ -375,54 +409,476 @@ namespace SABA
 
     void printDec(uint32_t dw, bool signedInt = false) /*const*/
     {
-      bool p= false;
-      uint32_t div= 1000000000;
       uint8_t fsize= 0;
       bool printMinus= false;
 
-      if( signedInt && int16_t(dw) < 0)
+      if( signedInt && int32_t(dw) < 0)
       {
         printMinus= true;
-        dw= uint32_t(- int32_t(dw));
+        dw= uint32_t(0 - dw);
       }
 
       if( fwidth != 0 )
       {
         fsize= 10;
-        for(;div > 1; div /= 10,--fsize)
-          if(dw >= div)
-            break;
+        for(uint8_t i=0;i < 9 && dw < pgm_read_dword(&DEC_POWERS32[i]);i++)
+          --fsize;
 
         if( printMinus )
           ++fsize;
-
-        div= 1000000000;
       }
       
       if( (fmtflags & ios_base::adjust) == ios_base::right && fwidth > fsize)
         printFill(fwidth - fsize);
         
       if( printMinus )
-        putch('-');
+        put('-');
+
+      printDigits(dw);
+       
+      if( (fmtflags & ios_base::adjust) == ios_base::left && fwidth > fsize)
+        printFill(fwidth - fsize);
+     
+    }
 
-      for(;div > 0; div /= 10)
+    void printFixed(int32_t raw, uint8_t fracBits)
+    {
+      uint8_t fsize= 0;
+      uint32_t dw= raw < 0 ? uint32_t(0 - uint32_t(raw)) : uint32_t(raw);
+      uint32_t integer= dw >> fracBits;
+      uint16_t fraction= 0;
+
+      if( fprecision != 0 )
       {
-        if( p || div == 1 || dw >= div)
+        // the fraction scaled to the decimal places, rounded to even by the remaining binary places
+        uint16_t power= pgm_read_word(&DEC_POWERS16[4 - fprecision]);
+        uint32_t mask= (uint32_t(1) << fracBits) - 1;
+        uint32_t scaled= (dw & mask) * power;
+        uint32_t rest= scaled & mask;
+        uint32_t half= (uint32_t(1) << fracBits) >> 1;
+
+        fraction= uint16_t(scaled >> fracBits);
+        if( rest > half || (rest == half && half != 0 && (fraction & 1)) )
+          ++fraction;
+
+        if( fraction == power )
         {
-          putch( '0' + ( dw / div ) );
-          dw %= div;
-          p= true;
+          fraction= 0;
+          ++integer;
         }
       }
-       
+      else
+      {
+        uint32_t half= (uint32_t(1) << fracBits) >> 1;
+        uint32_t rest= dw & ((uint32_t(1) << fracBits) - 1);
+
+        if( rest > half || (rest == half && half != 0 && (integer & 1)) )
+          ++integer;
+      }
+
+      if( fwidth != 0 )
+      {
+        fsize= 10;
+        for(uint8_t i=0;i < 9 && integer < pgm_read_dword(&DEC_POWERS32[i]);i++)
+          --fsize;
+
+        if( raw < 0 )
+          ++fsize;
+        if( fprecision != 0 )
+          fsize += 1 + fprecision;
+      }
+
+      if( (fmtflags & ios_base::adjust) == ios_base::right && fwidth > fsize)
+        printFill(fwidth - fsize);
+
+      if( raw < 0 )
+        put('-');
+
+      printDigits(integer);
+
+      if( fprecision != 0 )
+      {
+        put('.');
+        printDigits(fraction, 5 - fprecision);
+      }
+
       if( (fmtflags & ios_base::adjust) == ios_base::left && fwidth > fsize)
         printFill(fwidth - fsize);
-     
+    }
+
+    //! print the decimal digits by subtraction of the powers of ten, without leading zeros
+    void printDigits(uint32_t dw)
+    {
+      // the upper digits by 32 bit subtraction, the remainder < 10000 fits 16 bit
+      bool p= false;
+      for(uint8_t i=0;i < 6;i++)
+      {
+        uint32_t power= pgm_read_dword(&DEC_POWERS32[i]);
+        char digit= '0';
+        while( dw >= power )
+        {
+          dw -= power;
+          ++digit;
+        }
+
+        if( p || digit != '0' )
+        {
+          put( digit );
+          p= true;
+        }
+      }
+
+      if( p )
+        printDigits(uint16_t(dw), 1);
+      else
+        printDigits(uint16_t(dw));
+    }
+
+    //! print the decimal digits by subtraction of the powers of ten, without leading zeros
+    //! @param first the first power of DEC_POWERS16 to print, 1 prints 4 digits, 4 one digit with leading zeros
+    void printDigits(uint16_t w, uint8_t first = 0)
+    {
+      bool p= first != 0;
+      for(uint8_t i=first;i < 4;i++)
+      {
+        uint16_t power= pgm_read_word(&DEC_POWERS16[i]);
+        char digit= '0';
+        while( w >= power )
+        {
+          w -= power;
+          ++digit;
+        }
+
+        if( p || digit != '0' )
+        {
+          put( digit );
+          p= true;
+        }
+      }
+
+      put( '0' + uint8_t(w) );
+    }
+  };
+
+  // \brief A C++ output stream class
+  /** 
+  This class is used to output text similar to std::ostream.
+  @tparam output The putch function receiving the output
+
+  Usage:
+  ~~~{.c}
+  // the OStream putch method redirects output to the Usart
+  void putch(uint8_t c)
+  {
+    usart.putch(c);
+  }
+
+  SABA::OStream <&putch> out;
+
+  out << PSTR("Hello World!") << SABA::endl;
+  out << PSTR("The answer to everything is:") <<  SABA::dec << 42 << SABA::endl;
+  ~~~ 
+  */
+  template<PUTCH output>
+  class OStream : public BasicOStream<OStream<output> >
+  {
+    public:
+
+    static void putch(uint8_t c) //! writes a single character to the output function
+    {
+      output(c);
+    }
+  };
+
+  // \brief An output stream into a RAM buffer
+  /** 
+  This class is used to compose text in RAM similar to std::ostringstream, e.g. a display line, which can be
+  transferred as one block. It supports the same formatting as OStream. The text is truncated, if the buffer is full.
+  The buffer is provided by the caller, use FixedOStringStream for an embedded buffer.
+
+  Usage:
+  ~~~{.c}
+  char line[17];
+  SABA::OStringStream lineStream(line, sizeof(line));
+
+  lineStream << PSTR("T: ") << SABA::Fixed<8,8>(temperature) << PSTR(" C");
+  tm1638.writeData(0, lineStream.length(), (uint8_t *)lineStream.str());
+  ~~~ 
+  */
+  class OStringStream : public BasicOStream<OStringStream>
+  {
+    public:
+
+    //! the size includes the terminating 0, so the text length is max size - 1
+    OStringStream(char *buffer, uint8_t size) : buffer(buffer), size(size)
+    {
+    }
+
+    void putch(uint8_t c) //! appends a single character, if the buffer is not full
+    {
+      if( textLength < size - 1 )
+        buffer[textLength++]= c;
+      else
+        overflow= true;
+    }
+
+    const char *str() //! the 0 terminated text
+    {
+      buffer[textLength]= 0;
+
+      return buffer;
+    }
+
+    uint8_t length() //! the length of the text without the terminating 0
+    {
+      return textLength;
+    }
+
+    bool truncated() //! true, if characters have been dropped because the buffer was full
+    {
+      return overflow;
+    }
+
+    void clear() //! starts a new text, the format flags are kept
+    {
+      textLength= 0;
+      overflow= false;
+    }
+
+    private:
+
+    char *buffer;
+    uint8_t size;
+    uint8_t textLength = 0;
+    bool overflow = false;
+  };
+
+  // \brief An output stream into an embedded RAM buffer
+  /** 
+  An OStringStream with a buffer of SIZE characters including the terminating 0.
+  @tparam SIZE the buffer size, max 255
+
+  Usage:
+  ~~~{.c}
+  SABA::FixedOStringStream<17> line;
+
+  line << SABA::dec << PSTR("Count: ") << count;
+  if( line.truncated() )
+    ...
+  ~~~ 
+  */
+  template<uint8_t SIZE>
+  class FixedOStringStream : public OStringStream
+  {
+    static_assert(SIZE > 0, "FixedOStringStream needs space for the terminating 0");
+
+    public:
+
+    FixedOStringStream() : OStringStream(text, SIZE)
+    {
+    }
+
+    private:
+
+    char text[SIZE];
+  };
+
+  //! the severity of a message written to a TeeOStream, the values are bits of the sink masks
+  enum Severity
+  {
+    SeverityDebug = 1,
+    SeverityInfo = 2,
+    SeverityWarning = 4,
+    SeverityError = 8,
+    SeverityAll = 0x0f
+  };
+
+  // \brief A compile time list of putch functions
+  /** 
+  The static putch writes a character to all sinks, the calls are inlined. It can be used as putch of an OStream,
+  TeeOStream additionally masks the sinks by severity.
+  @tparam sinks The putch functions, max 8
+
+  Usage:
+  ~~~{.c}
+  SABA::OStream<&SABA::Sinks<&uartPutch, &ringPutch>::putch> out;
+  ~~~ 
+  */
+  template<PUTCH... sinks> struct Sinks;
+
+  template<> struct Sinks<>
+  {
+    static constexpr uint8_t count = 0;
+
+    static void putch(uint8_t /*c*/)
+    {
+    }
+
+    static void putch(uint8_t /*c*/, uint8_t /*enabled*/)
+    {
+    }
+  };
+
+  template<PUTCH first, PUTCH... rest> struct Sinks<first, rest...>
+  {
+    static constexpr uint8_t count = 1 + sizeof...(rest);
+
+    static_assert(count <= 8, "Sinks supports max 8 putch functions");
+
+    static void putch(uint8_t c) //! writes to all sinks
+    {
+      first(c);
+      Sinks<rest...>::putch(c);
+    }
+
+    static void putch(uint8_t c, uint8_t enabled) //! writes to the sinks with a set bit in enabled, bit 0 is the first sink
+    {
+      if( enabled & 1 )
+        first(c);
+      Sinks<rest...>::putch(c, enabled >> 1);
+    }
+  };
+
+  // \brief An output stream writing to several sinks
+  /** 
+  Each character is written to all sinks accepting the current severity. The enabled sinks are evaluated, if the
+  severity or a mask changes, so the costs per character are a bit test per sink.
+  @tparam SINKS A Sinks list of putch functions
+
+  Usage:
+  ~~~{.c}
+  SABA::TeeOStream<SABA::Sinks<&uartPutch, &lcdPutch, &ringPutch> > log;
+
+  log.mask(1, SABA::SeverityError);                      // only errors on the LCD
+  log.mask(2, SABA::SeverityWarning | SABA::SeverityError);
+
+  log.severity(SABA::SeverityError);
+  log << PSTR("I2C timeout") << SABA::endl;
+  ~~~ 
+  */
+  template<class SINKS>
+  class TeeOStream : public BasicOStream<TeeOStream<SINKS> >
+  {
+    public:
+
+    TeeOStream()
+    {
+      for(uint8_t i=0;i < SINKS::count;i++)
+        masks[i]= SeverityAll;
+    }
+
+    void putch(uint8_t c) //! writes a single character to the enabled sinks
+    {
+      SINKS::putch(c, enabled);
+    }
+
+    void severity(Severity newSeverity) //! sets the severity of the following output
+    {
+      current= newSeverity;
+      enabled= 0;
+      for(uint8_t i=0;i < SINKS::count;i++)
+      {
+        if( masks[i] & current )
+          enabled |= uint8_t(1 << i);
+      }
+    }
+
+    void mask(uint8_t sink, uint8_t severities) //! sets the severities accepted by a sink, an or of Severity values, an invalid sink is ignored
+    {
+      if( sink >= SINKS::count )
+        return;
+
+      masks[sink]= severities;
+      severity(Severity(current));
+    }
+
+    private:
+
+    uint8_t masks[SINKS::count];
+    uint8_t current = SeverityAll;
+    uint8_t enabled = 0xff;
+  };
+
+  //! when a StreamBuffer hands the buffer to the PUTBLOCK function
+  enum FlushPolicy
+  {
+    Unbuffered,     //!< every character
+    LineBuffered,   //!< at the end of a line or if the buffer is full
+    FullBuffered    //!< if the buffer is full or flush() is called
+  };
+
+  // \brief An output buffer collecting characters for a PUTBLOCK function
+  /** 
+  The buffer is static, so all streams and classes using the same putch share it, e.g. the temporary
+  OStream objects created by CmdLine and Monitor.
+  @tparam putblock The function receiving the buffered output
+  @tparam SIZE the buffer size, max 255
+  @tparam POLICY the FlushPolicy
+  */
+  template<PUTBLOCK putblock, uint8_t SIZE, FlushPolicy POLICY>
+  class StreamBuffer
+  {
+    public:
+
+    static void putch(uint8_t ch) //! add a character to the buffer, flushes according to the POLICY
+    {
+      buffer[length++]= ch;
+
+      if( POLICY == Unbuffered || length >= SIZE || (POLICY == LineBuffered && ch == '\n') )
+        flush();
+    }
+
+    static void flush() //! hand the buffer to the PUTBLOCK function
+    {
+      if( length != 0 )
+      {
+        putblock(buffer, length);
+        length= 0;
+      }
+    }
+
+    private:
+
+    static uint8_t buffer[SIZE];
+    static uint8_t length;
+  };
+
+  template<PUTBLOCK putblock, uint8_t SIZE, FlushPolicy POLICY> uint8_t StreamBuffer<putblock,SIZE,POLICY>::buffer[SIZE];
+  template<PUTBLOCK putblock, uint8_t SIZE, FlushPolicy POLICY> uint8_t StreamBuffer<putblock,SIZE,POLICY>::length= 0;
+
+  // \brief A buffered C++ output stream class
+  /** 
+  An OStream writing into a StreamBuffer. It can be used like OStream, the StreamBuffer putch can be used as putch
+  for CmdLine and Monitor.
+  @tparam putblock The function receiving the buffered output
+  @tparam SIZE the buffer size, max 255
+  @tparam POLICY the FlushPolicy
+
+  Usage:
+  ~~~{.c}
+  void putblock(const uint8_t *data, uint8_t length)
+  {
+    usart.write(data, length);
+  }
+
+  SABA::BufferedOStream <&putblock,32,SABA::LineBuffered> out;
+
+  out << PSTR("Hello World!") << SABA::endl;  // one call of putblock
+  ~~~ 
+  */
+  template<PUTBLOCK putblock, uint8_t SIZE, FlushPolicy POLICY = LineBuffered>
+  class BufferedOStream : public OStream<&StreamBuffer<putblock,SIZE,POLICY>::putch>
+  {
+    public:
+
+    void flush() //! hand the buffered output to the PUTBLOCK function
+    {
+      StreamBuffer<putblock,SIZE,POLICY>::flush();
     }
   };
 
   //! add a CR and LF (new line)
-  template<PUTCH p> OStream<p>& /*inline*/ endl(OStream<p>& ostr)
+  template<class S> BasicOStream<S>& /*inline*/ endl(BasicOStream<S>& ostr)
   {
     ostr << '\r' << '\n';
 
@@ -430,39 +886,39 @@ namespace SABA
   }
 
   //! switch to hexadecimal output
-  template<PUTCH p> OStream<p>& hex(OStream<p>& ostr)
+  template<class S> BasicOStream<S>& hex(BasicOStream<S>& ostr)
   {
-    ostr.setf( OStream<p>::hex, OStream<p>::base);
+    ostr.setf( ios_base::hex, ios_base::base);
 
     return ostr;
   }
 
   //! switch to decimal output
-  template<PUTCH p> OStream<p>& dec(OStream<p>& ostr)
+  template<class S> BasicOStream<S>& dec(BasicOStream<S>& ostr)
   {
-    ostr.setf( OStream<p>::dec, OStream<p>::base);
+    ostr.setf( ios_base::dec, ios_base::base);
 
     return ostr;
   }
 
   //! left adjust
-  template<PUTCH p> OStream<p>& left(OStream<p>& ostr)
+  template<class S> BasicOStream<S>& left(BasicOStream<S>& ostr)
   {
-    ostr.setf( OStream<p>::left, OStream<p>::adjust);
+    ostr.setf( ios_base::left, ios_base::adjust);
 
     return ostr;
   }
 
   //! right adjust
-  template<PUTCH p> OStream<p>& right(OStream<p>& ostr)
+  template<class S> BasicOStream<S>& right(BasicOStream<S>& ostr)
   {
-    ostr.setf( OStream<p>::right, OStream<p>::adjust);
+    ostr.setf( ios_base::right, ios_base::adjust);
 
     return ostr;
   }
 
   //! set width
-  template<PUTCH p> OStream<p>& setw(OStream<p>& ostr, const int w)
+  template<class S> BasicOStream<S>& setw(BasicOStream<S>& ostr, const int w)
   {
     ostr.width( uint8_t(w) );
 
@@ -0,0 +1,207 @@
+/*
+ * saba_profiler.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Main loop load and latency profiler
+ */
+
+#ifndef SABA_PROFILER_H_
+#define SABA_PROFILER_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#include <saba_avr.h>
+#include <saba_timing.h>
+#include <saba_clock.h>
+
+/** mark a main loop iteration of a LoopProfiler
+ * Only if PROFILE_LOOP is defined, otherwise the profiler is compiled out completely.
+ *
+ * Usage:
+ * ~~~{.c}
+ * for(;;)
+ * {
+ *   SABA_PROFILE(Profiler);
+ *   ...
+ * }
+ * ~~~
+ */
+#ifdef PROFILE_LOOP
+#define SABA_PROFILE(PROFILER)    PROFILER::iteration()
+#else
+#define SABA_PROFILE(PROFILER)
+#endif
+
+namespace SABA
+{
+  //! the number of significant bits of a nibble
+  const uint8_t NIBBLE_BITS[] PROGMEM = { 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+
+  // \brief Main loop profiler
+  /**
+  Measures the time between two calls of iteration() with the timer counter and SABA::Timing::ticker. The timer
+  overflow increments the ticker, PERIOD is the number of timer counts per tick, e.g. ICR1 + 1 in FAST_PWM_ICR1 mode.
+  The time is measured in timer counts, saturated at 0xffff. It keeps the minimum and maximum, the average and the
+  iterations of the last second and a histogram in power of two buckets: bucket 0 counts 0, bucket i counts
+  2^(i-1) up to 2^i - 1. The Monitor command profile prints them.
+  An iteration costs 16 bit arithmetic, the multiplication by PERIOD is done only after a tick and when the second
+  is over, the average is the time of the second divided by its iterations.
+  @tparam COUNTER the counter of the ticker timer, e.g. SABA::Timing::Timer1Counter
+  @tparam PERIOD the timer counts per tick
+  @tparam TICKS_PER_SECOND the ticks per second
+
+  Usage:
+  ~~~{.c}
+  typedef SABA::LoopProfiler<SABA::Timing::Timer1Counter,626,100> Profiler;
+
+  { "profile", &DebugMonitor::profile<Profiler>, helpProfile },
+  ~~~
+  */
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND>
+  class LoopProfiler
+  {
+    public:
+
+    static constexpr uint8_t BUCKETS = 17;
+
+    static void iteration() //! call it once per main loop iteration
+    {
+      uint16_t tick, count;
+      do
+      {
+        tick= uint16_t(Timing::ticker);
+        count= COUNTER::count();
+      }
+      while( tick != uint16_t(Timing::ticker) );
+
+      // the multiplication is needed only, if a tick passed since the last iteration
+      uint16_t ticks= tick - lastTick;
+      uint16_t diff= count - lastCount;
+      if( ticks != 0 )
+      {
+        uint32_t time= uint32_t(ticks) * PERIOD + count - lastCount;
+        diff= time > 0xffff ? 0xffff : uint16_t(time);
+      }
+
+      lastTick= tick;
+      lastCount= count;
+
+      if( !started )
+      {
+        started= true;
+        secondStart= tick;
+        secondCount= count;
+        return;
+      }
+
+      if( diff < minTime )
+        minTime= diff;
+      if( diff > maxTime )
+        maxTime= diff;
+
+      uint16_t& entry= histogram[bucket(diff)];
+      if( entry != 0xffff )
+        ++entry;
+
+      ++iterations;
+
+      // the sum of the iterations is the time since the window started
+      if( uint16_t(tick - secondStart) >= TICKS_PER_SECOND )
+      {
+        lastSum= uint32_t(uint16_t(tick - secondStart)) * PERIOD + count - secondCount;
+        lastIterations= iterations;
+        secondStart= tick;
+        secondCount= count;
+        iterations= 0;
+      }
+    }
+
+    static void reset() //! restart all statistics
+    {
+      started= false;
+      minTime= 0xffff;
+      maxTime= 0;
+      iterations= 0;
+      lastSum= 0;
+      lastIterations= 0;
+      for(uint8_t i=0;i < BUCKETS;i++)
+        histogram[i]= 0;
+    }
+
+    static uint16_t minimum() //! the shortest iteration in timer counts, 0xffff if none
+    {
+      return minTime;
+    }
+
+    static uint16_t maximum() //! the longest iteration in timer counts
+    {
+      return maxTime;
+    }
+
+    static uint16_t average() //! the average iteration in timer counts during the last second
+    {
+      return lastIterations == 0 ? 0 : uint16_t(lastSum / lastIterations);
+    }
+
+    static uint32_t perSecond() //! the iterations during the last second
+    {
+      return lastIterations;
+    }
+
+    static uint16_t bucketCount(uint8_t i) //! the iterations of histogram bucket i, saturated at 0xffff
+    {
+      return histogram[i];
+    }
+
+    static uint8_t bucket(uint16_t diff) //! the histogram bucket of an iteration time, its number of significant bits
+    {
+      uint8_t i= 0;
+      uint8_t b= uint8_t(diff);
+      if( diff > 0xff )
+      {
+        i= 8;
+        b= uint8_t(diff >> 8);
+      }
+      if( b > 0xf )
+      {
+        i += 4;
+        b >>= 4;
+      }
+
+      return i + pgm_read_byte(&NIBBLE_BITS[b]);
+    }
+
+    private:
+
+    static bool started;
+    static uint16_t lastTick;
+    static uint16_t lastCount;
+    static uint16_t secondStart;
+    static uint16_t secondCount;
+    static uint16_t minTime;
+    static uint16_t maxTime;
+    static uint32_t iterations;
+    static uint32_t lastSum;
+    static uint32_t lastIterations;
+    static uint16_t histogram[BUCKETS];
+  };
+
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> bool LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::started;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::lastTick;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::lastCount;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::secondStart;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::secondCount;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::minTime = 0xffff;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::maxTime;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint32_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::iterations;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint32_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::lastSum;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint32_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::lastIterations;
+  template<class COUNTER, uint16_t PERIOD, uint16_t TICKS_PER_SECOND> uint16_t LoopProfiler<COUNTER,PERIOD,TICKS_PER_SECOND>::histogram[BUCKETS];
+}
+
+#endif // SABA_PROFILER_H_
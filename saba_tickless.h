@@ -0,0 +1,322 @@
+/*
+ * saba_tickless.h
+ *
+ * Saarbastler AVR C++ 11 Library
+ *
+ * Created: 17.10.2026
+ * Author: Joerg
+ *
+ * Tickless timing with Timer1: a free running 32 bit clock and OCR1A programmed to the next deadline
+ */
+
+#ifndef SABA_TICKLESS_H_
+#define SABA_TICKLESS_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include <saba_avr.h>
+#include <saba_timer.h>
+#include <saba_timing.h>
+#include <saba_clock.h>
+
+namespace SABA
+{
+  namespace Timing
+  {
+#ifdef TIMSK1
+    //! the Timer1 registers used by TicklessTimer1, the counter, the overflow flag and the output compare A
+    struct Timer1CompareA : Timer1Counter
+    {
+      static void initialize(Timer16::ClockSelect clockSelect) //! starts Timer1 in Normal mode with the overflow interrupt
+      {
+        Timer1 timer1;
+
+        timer1.clockSelect(Timer16::NoClockSource)
+          .waveformGenerationMode(Timer16::Normal)
+          .enableOutputCompAMatchInterrupt(false)
+          .enableOverflowInterrupt(true);
+        timer1= 0;
+        TIFR1= BIT(TOV1) | BIT(OCF1A);
+        timer1.clockSelect(clockSelect);
+      }
+
+      static void setCompare(uint16_t value)
+      {
+        OCR1A= value;
+      }
+
+      static void enableCompare() //! clears a past match and enables the interrupt
+      {
+        TIFR1= BIT(OCF1A);
+        TIMSK1 |= BIT(OCIE1A);
+      }
+
+      static void disableCompare()
+      {
+        TIMSK1 &= uint8_t(~BIT(OCIE1A));
+      }
+    };
+#endif
+
+    template<class TIMER, Timer16::ClockSelect CLOCK_SELECT> class TicklessTimer1;
+
+    // A timer of TicklessTimer1, the same usage as ScheduledCallbackDelay, but the delay is in Timer1 counts
+    // and the callback is optional: operator() is true only once, if the delay is done.
+    class TicklessDelay
+    {
+      public:
+
+      bool isRunning()
+      {
+        return mode == Running;
+      }
+
+      bool operator()()
+      {
+        if( mode != Stopped )
+          return false;
+
+        mode= Done;
+        return true;
+      }
+
+      protected:
+
+      enum Mode
+      {
+        Running= 0, Stopped= 1, Done= 2
+      };
+
+      TicklessDelay *next= nullptr;
+      uint32_t deadline= 0;
+      Mode mode= Done;
+      Callback callback= nullptr;
+      void *callbackEnv= nullptr;
+
+      template<class TIMER, Timer16::ClockSelect CLOCK_SELECT> friend class TicklessTimer1;
+    };
+
+    // \brief Tickless timing with Timer1
+    /**
+    Timer1 runs free in Normal mode, the overflow interrupt extends TCNT1 to a 32 bit clock. The armed delays are
+    sorted by their deadline, OCR1A is set to the earliest one, if it is within the current overflow period, otherwise
+    the overflow interrupt arms it later. There is no periodic tick, the CPU wakes up only for a due delay or another
+    interrupt, sleep() enters the idle sleep mode until then.
+    The resolution is one Timer1 count, e.g. 0.5 us with By8 at 16 MHz, a delay can be up to 2^31 counts.
+    Timing::ticker is not incremented in this mode, the polled delay classes and the Scheduler need a separate tick.
+    @tparam TIMER the counter, overflow flag and output compare, e.g. Timer1CompareA
+    @tparam CLOCK_SELECT the Timer1 prescaler
+
+    Usage:
+    ~~~{.c}
+    SABA::Timing::TicklessTimer1<SABA::Timing::Timer1CompareA,SABA::Timer16::By8> tickless;
+    SABA::Timing::TicklessDelay ledDelay;
+
+    ISR(TIMER1_OVF_vect)
+    {
+      tickless.overflow();
+    }
+
+    ISR(TIMER1_COMPA_vect)
+    {
+      tickless.compareMatch();
+    }
+
+    tickless.initialize();
+    tickless.start(ledDelay, tickless.fromMicros(500000));
+
+    for(;;)
+    {
+      tickless.cyclic();
+      if( ledDelay() )
+        ...
+      tickless.sleep();
+    }
+    ~~~
+    */
+    template<class TIMER, Timer16::ClockSelect CLOCK_SELECT>
+    class TicklessTimer1
+    {
+      public:
+
+      static constexpr uint16_t PRESCALER = Timer16::prescaler(CLOCK_SELECT);
+
+      static_assert(PRESCALER != 0, "a prescaled clkIO is needed");
+
+#ifdef F_CPU
+      //! the Timer1 counts of us microseconds, rounded down
+      static constexpr uint32_t fromMicros(uint32_t us)
+      {
+        return uint64_t(us) * (F_CPU / 1000) / (1000UL * PRESCALER);
+      }
+#endif
+
+      void initialize() //! starts Timer1 in Normal mode with the overflow interrupt
+      {
+        TIMER::initialize(CLOCK_SELECT);
+      }
+
+      uint32_t now() //! the 32 bit time in Timer1 counts, may be called with interrupts enabled or disabled
+      {
+        uint8_t sreg= SREG;
+        cli();
+
+        uint16_t low= TIMER::count();
+        uint16_t high= overflows;
+
+        // an overflow is pending, if TCNT1 wrapped since the last overflow interrupt
+        if( TIMER::overflowPending() && low < 0x8000 )
+          ++high;
+
+        SREG= sreg;
+
+        return (uint32_t(high) << 16) | low;
+      }
+
+      void start(TicklessDelay& delay, uint32_t counts, void *env = nullptr, Callback callback = nullptr) //! arms the delay, the callback is optional
+      {
+        cancel(delay);
+
+        delay.callback= callback;
+        delay.callbackEnv= env;
+        delay.deadline= now() + counts;
+        delay.mode= TicklessDelay::Running;
+
+        TicklessDelay **p= &head;
+        for(;*p != nullptr && int32_t((*p)->deadline - delay.deadline) <= 0;p= &(*p)->next)
+          ;
+
+        delay.next= *p;
+        *p= &delay;
+
+        if( head == &delay )
+          arm();
+      }
+
+      void cancel(TicklessDelay& delay) //! stops the delay, operator() is false afterwards
+      {
+        if( delay.mode == TicklessDelay::Running )
+        {
+          for(TicklessDelay **p= &head;*p != nullptr;p= &(*p)->next)
+          {
+            if( *p == &delay )
+            {
+              *p= delay.next;
+              break;
+            }
+          }
+        }
+
+        delay.mode= TicklessDelay::Done;
+      }
+
+      void cyclic() //! stops the due delays and calls their callbacks, call it from the main loop
+      {
+        if( !due )
+          return;
+
+        due= false;
+
+        while( head != nullptr && int32_t(head->deadline - now()) <= 0 )
+        {
+          TicklessDelay *delay= head;
+          head= delay->next;
+          delay->mode= TicklessDelay::Stopped;
+
+          // the callback may start the delay again
+          if( delay->callback != nullptr )
+            delay->callback(delay->callbackEnv);
+        }
+
+        arm();
+      }
+
+      void sleep() //! idle sleep until the next interrupt, returns at once, if a delay is due
+      {
+        cli();
+        if( !due )
+        {
+          set_sleep_mode(SLEEP_MODE_IDLE);
+          sleep_enable();
+          // sei executes the next instruction before an interrupt, so no wake up is lost
+          sei();
+          sleep_cpu();
+          sleep_disable();
+        }
+        sei();
+      }
+
+      void overflow() //! call it from ISR(TIMER1_OVF_vect)
+      {
+        ++overflows;
+
+        if( armed && overflows == uint16_t(alarm >> 16) )
+          enableCompare();
+      }
+
+      void compareMatch() //! call it from ISR(TIMER1_COMPA_vect)
+      {
+        TIMER::disableCompare();
+        armed= false;
+        due= true;
+      }
+
+      private:
+
+      // sets OCR1A to the deadline of the head, the overflow interrupt enables it in the right period
+      void arm()
+      {
+        uint8_t sreg= SREG;
+        cli();
+
+        TIMER::disableCompare();
+        armed= false;
+
+        if( head != nullptr )
+        {
+          uint32_t time= now();
+          if( int32_t(head->deadline - time) <= 0 )
+          {
+            due= true;
+          }
+          else
+          {
+            alarm= head->deadline;
+            TIMER::setCompare(uint16_t(alarm));
+            armed= true;
+
+            if( uint16_t(time >> 16) == uint16_t(alarm >> 16) )
+              enableCompare();
+          }
+        }
+
+        SREG= sreg;
+      }
+
+      // called with interrupts disabled
+      void enableCompare()
+      {
+        TIMER::enableCompare();
+
+        // the match may have passed before the interrupt was enabled, TCNT1 alone may have wrapped meanwhile
+        if( int32_t(alarm - now()) <= 0 )
+        {
+          TIMER::disableCompare();
+          armed= false;
+          due= true;
+        }
+      }
+
+      TicklessDelay *head= nullptr;
+      volatile uint16_t overflows= 0;
+      volatile uint32_t alarm= 0;
+      volatile bool armed= false;
+      volatile bool due= false;
+    };
+  }
+}
+
+#endif // SABA_TICKLESS_H_
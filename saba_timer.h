@@ -215,6 +215,12 @@ namespace SABA
       TxRising= 7         /**< External clock source on T0/1 pin. Clock on rising edge. */
     };
 
+    /// the prescaler factor of a clock selection, 0 for no clock or an external clock
+    constexpr uint16_t prescaler(ClockSelect c)
+    {
+      return c == By1 ? 1 : c == By8 ? 8 : c == By64 ? 64 : c == By256 ? 256 : c == By1024 ? 1024 : 0;
+    }
+
     /// The 16 Bit Timer WaveformGenerationMode enum
     enum WaveformGenerationMode
     {
@@ -12,6 +12,10 @@
 #ifndef SABA_TIMING_H_
 #define SABA_TIMING_H_
 
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
 #define ISR_INCREMENTUINT16(VAR)  \
   asm volatile                    \
   (                               \
@@ -32,7 +36,36 @@
   "reti"                          \
   :: "m" (VAR), "i" (&SREG)       \
   )                               \
-  
+
+#define ISR_INCREMENTUINT32(VAR)  \
+  asm volatile                    \
+  (                               \
+  "push r16"        "\n\t"        \
+  "in r16,%i1"      "\n\t"        \
+  "push r16"        "\n\t"        \
+  "lds  r16, %A0"   "\n\t"        \
+  "inc  r16"        "\n\t"        \
+  "sts  %A0, r16"   "\n\t"        \
+  "brne 0f"         "\n\t"        \
+  "lds  r16, %A0+1" "\n\t"        \
+  "inc  r16"        "\n\t"        \
+  "sts  %A0+1, r16" "\n\t"        \
+  "brne 0f"         "\n\t"        \
+  "lds  r16, %A0+2" "\n\t"        \
+  "inc  r16"        "\n\t"        \
+  "sts  %A0+2, r16" "\n\t"        \
+  "brne 0f"         "\n\t"        \
+  "lds  r16, %A0+3" "\n\t"        \
+  "inc  r16"        "\n\t"        \
+  "sts  %A0+3, r16" "\n\t"        \
+  "0:"              "\n\t"        \
+  "pop  r16"        "\n\t"        \
+  "out  %i1, r16"   "\n\t"        \
+  "pop  r16"        "\n\t"        \
+  "reti"                          \
+  :: "m" (VAR), "i" (&SREG)       \
+  )                               \
+
 namespace SABA
 {
   /**
@@ -44,11 +77,95 @@ namespace SABA
     // increment this system ticker periodically by an timer interrupt
     // define it as volatile uint16_t SABA::Timing::ticker;
     // The macro ISR_INCREMENTUINT16 is an ISR increment method
+    // If TICKER_32BIT is defined, define it as volatile uint32_t SABA::Timing::ticker; and use ISR_INCREMENTUINT32
+#ifdef TICKER_32BIT
+    extern volatile uint32_t ticker;
+#else
     extern volatile uint16_t ticker;
+#endif
+
+    // an ISR safe snapshot of the lower 16 bits of the ticker
+    inline uint16_t now16()
+    {
+      uint8_t sreg= SREG;
+      cli();
+      uint16_t value= uint16_t(ticker);
+      SREG= sreg;
+
+      return value;
+    }
+
+    // the 32 bit time in ticks, an ISR safe snapshot of the ticker.
+    // A 16 bit ticker is extended by an epoch counter, counting its wrap arounds. Then now() has to be called
+    // from the main loop only, at least once per 65536 ticks, e.g. by a running delay or Deadline.
+    inline uint32_t now()
+    {
+#ifdef TICKER_32BIT
+      uint8_t sreg= SREG;
+      cli();
+      uint32_t value= ticker;
+      SREG= sreg;
+
+      return value;
+#else
+      static uint16_t last;
+      static uint16_t epoch;
+
+      uint16_t value= now16();
+      if( value < last )
+        ++epoch;
+      last= value;
+
+      return (uint32_t(epoch) << 16) | value;
+#endif
+    }
+
+    // the ticks since start, a value of now(), correct across the wrap around
+    inline uint32_t elapsed(uint32_t start)
+    {
+      return now() - start;
+    }
+
+    // the snapshot used by the delay classes: 8 and 16 bit delays need the lower 16 bits only
+    template<typename TYPE> inline TYPE ticks()
+    {
+      return TYPE(now16());
+    }
+
+    template<> inline uint32_t ticks<uint32_t>()
+    {
+      return now();
+    }
+
+    // A point in time, up to 2^31 - 1 ticks in the future
+    class Deadline
+    {
+      public:
+      void set(uint32_t delay)
+      {
+        due= now() + delay;
+      }
+
+      bool expired()
+      {
+        return int32_t(now() - due) >= 0;
+      }
+
+      // the ticks until the deadline, 0 if expired
+      uint32_t remaining()
+      {
+        int32_t diff= int32_t(due - now());
+        return diff > 0 ? uint32_t(diff) : 0;
+      }
+
+      private:
+
+      uint32_t due= 0;
+    };
 
     typedef void(*Callback)(void *env);
 
-    // delay a fixed time. TYPE is either uint8_t or uint16_t for max 255/65535 delay time
+    // delay a fixed time. TYPE is uint8_t, uint16_t or uint32_t for max 255/65535/2^32-1 delay time
     // Can be re triggered or re started again.
     template<typename TYPE, TYPE delay>
     class SingleDelayFixed
@@ -61,7 +178,7 @@ namespace SABA
       
       void start()
       {
-        startValue= ticker;
+        startValue= ticks<TYPE>();
         mode= Running;
       }
 
@@ -91,7 +208,7 @@ namespace SABA
       {
         if( mode == Running )
         {
-          TYPE diff= ticker - startValue;
+          TYPE diff= ticks<TYPE>() - startValue;
 
           if(diff >= delay)
           mode= Stopped;
@@ -107,7 +224,7 @@ namespace SABA
       Mode mode= Done;
     };
 
-    // delay a fixed time. TYPE is either uint8_t or uint16_t for max 255/65535 delay time
+    // delay a fixed time. TYPE is uint8_t, uint16_t or uint32_t for max 255/65535/2^32-1 delay time
     // Can be re triggered or re started again. Cyclic has to get called regularly.
     template<typename TYPE, TYPE delay>
     class CallbackDelayFixed
@@ -125,7 +242,7 @@ namespace SABA
 
       void start(void *env, Callback callback_)
       {
-        startValue= ticker;
+        startValue= ticks<TYPE>();
         mode= Running;
 
         callback= callback_;
@@ -154,7 +271,7 @@ namespace SABA
       {
         if( mode == Running )
         {
-          TYPE diff= ticker - startValue;
+          TYPE diff= ticks<TYPE>() - startValue;
 
           if(diff >= delay)
             mode= Stopped;
@@ -173,7 +290,7 @@ namespace SABA
     };
     
     
-    // delay a  time. TYPE is either uint8_t or uint16_t for max 255/65535 delay time
+    // delay a  time. TYPE is uint8_t, uint16_t or uint32_t for max 255/65535/2^32-1 delay time
     // Can be re triggered or re started again.
     template<typename TYPE>
     class SingleDelay
@@ -187,7 +304,7 @@ namespace SABA
       void start(TYPE delay_)
       {
         delay= delay_;
-        startValue= ticker;
+        startValue= ticks<TYPE>();
         mode= Running;
       }
 
@@ -217,7 +334,7 @@ namespace SABA
       {
         if( mode == Running )
         {
-          TYPE diff= ticker - startValue;
+          TYPE diff= ticks<TYPE>() - startValue;
 
           if(diff >= delay)
           mode= Stopped;
@@ -235,7 +352,7 @@ namespace SABA
       Mode mode= Done;
     };
 
-    // delay a variable time. TYPE is either uint8_t or uint16_t for max 255/65535 delay time
+    // delay a variable time. TYPE is uint8_t, uint16_t or uint32_t for max 255/65535/2^32-1 delay time
     // Can be re triggered or re started again. Cyclic has to get called regularly.
     template<typename TYPE>
     class CallbackDelay
@@ -254,7 +371,7 @@ namespace SABA
       void start(TYPE delay_, void *env, Callback callback_)
       {
         delay= delay_;
-        startValue= ticker;
+        startValue= ticks<TYPE>();
         mode= Running;
 
         callback= callback_;
@@ -282,7 +399,7 @@ namespace SABA
       {
         if( mode == Running )
         {
-          TYPE diff= ticker - startValue;
+          TYPE diff= ticks<TYPE>() - startValue;
 
           if(diff >= delay)
             mode= Stopped;
@@ -300,6 +417,202 @@ namespace SABA
       Callback callback= nullptr;
       void *callbackEnv= nullptr;
     };
+
+    class Scheduler;
+
+    // A timer of the Scheduler, the base of ScheduledDelay and ScheduledCallbackDelay.
+    // The timers are linked into a list sorted by due time, each storing the ticks after its predecessor.
+    class ScheduledTask
+    {
+      protected:
+
+      enum Mode
+      {
+        Running= 0, Stopped= 1, Done= 2
+      };
+
+      ScheduledTask *next= nullptr;
+      uint16_t delta= 0;
+      Mode mode= Done;
+      Callback callback= nullptr;
+      void *callbackEnv= nullptr;
+
+      friend class Scheduler;
+    };
+
+    // Central timer service: the armed timers are kept in a delta sorted list, cyclic() only compares the ticker
+    // with the last tick and decrements the head of the list, no matter how many timers are armed. Starting a timer
+    // walks the list to its due position. The callbacks are called by cyclic() in due order.
+    // define it as SABA::Timing::Scheduler SABA::Timing::scheduler; and call scheduler.cyclic() from the main loop.
+    // The list is not protected against interrupts, start and stop the timers from the main loop only, not from an ISR.
+    class Scheduler
+    {
+      public:
+
+      void schedule(ScheduledTask& task, uint16_t delay)
+      {
+        cancel(task);
+
+        // The list is relative to lastTick, not to the current ticker. If no timer is due, lastTick is moved to the
+        // ticker, then the full 16 bit delay is available, even if cyclic was not called for a long time.
+        uint16_t behind= now16() - lastTick;
+        if( head == nullptr || head->delta > behind )
+        {
+          if( head != nullptr )
+            head->delta -= behind;
+          lastTick += behind;
+          behind= 0;
+        }
+
+        // due at the next tick at the earliest
+        if( delay == 0 )
+          delay= 1;
+        delay= delay > 0xffff - behind ? 0xffff : delay + behind;
+
+        ScheduledTask **p= &head;
+        for(;*p != nullptr && (*p)->delta <= delay;p= &(*p)->next)
+          delay -= (*p)->delta;
+
+        if( *p != nullptr )
+          (*p)->delta -= delay;
+
+        task.delta= delay;
+        task.next= *p;
+        task.mode= ScheduledTask::Running;
+        *p= &task;
+      }
+
+      void cancel(ScheduledTask& task)
+      {
+        if( task.mode == ScheduledTask::Running )
+        {
+          for(ScheduledTask **p= &head;*p != nullptr;p= &(*p)->next)
+          {
+            if( *p == &task )
+            {
+              *p= task.next;
+              if( task.next != nullptr )
+                task.next->delta += task.delta;
+              break;
+            }
+          }
+        }
+
+        task.mode= ScheduledTask::Done;
+      }
+
+      // advances the list to the ticker and calls the callbacks of the due timers
+      void cyclic()
+      {
+        uint16_t now= now16();
+        if( now == lastTick )
+          return;
+
+        for(;;)
+        {
+          // a callback may take longer than a tick, the timers due meanwhile are called in this cyclic, too
+          now= now16();
+          if( head == nullptr || head->delta > uint16_t(now - lastTick) )
+            break;
+
+          ScheduledTask *task= head;
+          head= task->next;
+          task->mode= ScheduledTask::Stopped;
+
+          // the list stays relative to the due time, the callback may start timers
+          lastTick += task->delta;
+          if( task->callback != nullptr )
+            task->callback(task->callbackEnv);
+        }
+
+        if( head != nullptr )
+          head->delta -= uint16_t(now - lastTick);
+        lastTick= now;
+      }
+
+      private:
+
+      ScheduledTask *head= nullptr;
+      uint16_t lastTick= 0;
+    };
+
+    extern Scheduler scheduler;
+
+    // delay a variable time with the Scheduler, max 65535 ticks. The same usage as SingleDelay,
+    // but the timer is not polled, the scheduler stops it. A running delay is removed from the list, if it is destroyed.
+    class ScheduledDelay : public ScheduledTask
+    {
+      public:
+      ~ScheduledDelay()
+      {
+        scheduler.cancel(*this);
+      }
+
+      void stop()
+      {
+        scheduler.cancel(*this);
+      }
+
+      void start(uint16_t delay)
+      {
+        callback= nullptr;
+        scheduler.schedule(*this, delay);
+      }
+
+      bool isRunning()
+      {
+        return mode == Running;
+      }
+
+      // is true only once, if the delay is done.
+      // has to be started again after delay is done.
+      bool operator()()
+      {
+        if( mode != Stopped )
+          return false;
+
+        mode= Done;
+        return true;
+      }
+    };
+
+    // delay a variable time with the Scheduler, max 65535 ticks. The same usage as CallbackDelay,
+    // the callback is called by Scheduler::cyclic, cyclic() of this class is not needed.
+    // A running delay is removed from the list, if it is destroyed.
+    class ScheduledCallbackDelay : public ScheduledTask
+    {
+      public:
+      ~ScheduledCallbackDelay()
+      {
+        scheduler.cancel(*this);
+      }
+
+      void stop()
+      {
+        scheduler.cancel(*this);
+      }
+
+      void start(uint16_t delay, Callback callback)
+      {
+        start( delay, 0, callback);
+      }
+
+      void start(uint16_t delay, void *env, Callback callback_)
+      {
+        callback= callback_;
+        callbackEnv= env;
+        scheduler.schedule(*this, delay);
+      }
+
+      bool operator()()
+      {
+        return mode == Running;
+      }
+
+      void cyclic()
+      {
+      }
+    };
   }
 
 }
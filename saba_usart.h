@@ -11,6 +11,7 @@
 
 #include <avr/io.h>
 #include <saba_avr.h>
+#include <saba_fifo.h>
 
 #include "Device.h"
 
@@ -19,6 +20,41 @@
 
 namespace SABA
 {
+  // \brief Compile time Usart baudrate calculation
+  /** 
+  Calculates UBRR for normal and double speed (U2X) mode and selects the one with the lower error. Double speed is only
+  used, if it is more accurate. A static_assert fails, if the error is above MAX_ERROR.
+  @tparam BAUDRATE the desired baudrate
+  @tparam MAX_ERROR the maximum baudrate error in 1/1000, the default is 2.5%
+  @tparam CPU_CLOCK the cpu clock, F_CPU by default
+  */
+  template<uint32_t BAUDRATE, uint16_t MAX_ERROR = 25, uint32_t CPU_CLOCK = F_CPU>
+  class UsartBaud
+  {
+    //! the rounded UBRR+1 divisor for 16 (normal) or 8 (double speed) clocks per bit
+    static constexpr uint32_t divisor(uint8_t clocksPerBit)
+    {
+      return (CPU_CLOCK + clocksPerBit * BAUDRATE / 2) / (clocksPerBit * BAUDRATE);
+    }
+
+    //! the baudrate error in 1/1000
+    static constexpr uint32_t error(uint8_t clocksPerBit)
+    {
+      return (divisor(clocksPerBit) == 0 || divisor(clocksPerBit) > 4096) ? 0xffff :
+        (uint64_t(CPU_CLOCK) * 1000 / (clocksPerBit * divisor(clocksPerBit)) > uint64_t(BAUDRATE) * 1000
+          ? uint64_t(CPU_CLOCK) * 1000 / (clocksPerBit * divisor(clocksPerBit)) - uint64_t(BAUDRATE) * 1000
+          : uint64_t(BAUDRATE) * 1000 - uint64_t(CPU_CLOCK) * 1000 / (clocksPerBit * divisor(clocksPerBit)) ) / BAUDRATE;
+    }
+
+  public:
+
+    static constexpr bool U2X = error(8) < error(16); //! true, if double speed mode is used
+    static constexpr uint16_t UBRR = uint16_t(divisor(U2X ? 8 : 16) - 1); //! the UBRR register value
+    static constexpr uint16_t ERROR_PERMILLE = uint16_t(error(U2X ? 8 : 16)); //! the baudrate error in 1/1000
+
+    static_assert(ERROR_PERMILLE != 0xffff, "Usart baudrate not possible with this CPU clock");
+    static_assert(ERROR_PERMILLE <= MAX_ERROR, "Usart baudrate error too big");
+  };
 
   // \brief Usart controlling class
   /** 
@@ -29,40 +65,36 @@ namespace SABA
   @tparam _UCSRC the UCSRC address
   @tparam _UBRRL the UBRRL address
   @tparam _UBRRH the UBRRH address
+  @tparam _RXCIE the receive complete interrupt enable bit
+  @tparam _UDRIE the data register empty interrupt enable bit
+  @tparam _U2X the double speed bit
 
   Usage:
   ~~~{.c}
   SABA::USART0 usart(19200);  // use one of the defined typedefs
+  SABA::USART0 usart(SABA::USART0::Baud<115200>{});  // UBRR and U2X calculated at compile time
   ~~~ 
   */
   template <SFRA _UDR,SFRA _UCSRA,SFRA _UCSRB,SFRA _UCSRC,SFRA _UBRRL,SFRA _UBRRH
-  ,uint8_t _RXEN,uint8_t _TXEN,uint8_t _UCSZ0,uint8_t _UCSZ1,uint8_t _TXC,uint8_t _RXC,uint8_t _UDRE>
+  ,uint8_t _RXEN,uint8_t _TXEN,uint8_t _UCSZ0,uint8_t _UCSZ1,uint8_t _TXC,uint8_t _RXC,uint8_t _UDRE,uint8_t _RXCIE,uint8_t _UDRIE,uint8_t _U2X>
   class Usart
   {
   public:
 
     Usart(uint32_t baudrate)  //! initializes the Usart using the desired baudrate
     {
-      uint16_t ubrr= (uint16_t)(.5 + F_CPU / (baudrate * 16))-1;
-
-      SFREG<_UCSRA> ucsra;
-      SFREG<_UCSRB> ucsrb;
-      SFREG<_UCSRC> ucsrc;
-      SFREG<_UBRRL> ubrrl;
-      SFREG<_UBRRH> ubrrh;
-
-      ubrrl= (uint8_t)ubrr & (uint8_t)0xff;
-      ubrrh= ubrr >> 8;
-      ucsra= 0;
-      ucsrb= BIT(_RXEN)|BIT(_TXEN);
+      initialize( (uint16_t)(.5 + F_CPU / (baudrate * 16))-1, false );
+    }
 
-// Atmega 8
-#ifdef URSEL
-      ucsrc= BIT(URSEL) | BIT(UCSZ0) | BIT(UCSZ1);
-#else
-      ucsrc= BIT(_UCSZ0) | BIT(_UCSZ1);
-#endif
+    template<uint32_t BAUDRATE, uint16_t MAX_ERROR, uint32_t CPU_CLOCK>
+    Usart(UsartBaud<BAUDRATE,MAX_ERROR,CPU_CLOCK>)  //! initializes the Usart using the compile time calculated baudrate
+    {
+      initialize( UsartBaud<BAUDRATE,MAX_ERROR,CPU_CLOCK>::UBRR, UsartBaud<BAUDRATE,MAX_ERROR,CPU_CLOCK>::U2X );
     }
+
+    //! the compile time baudrate calculation, see UsartBaud
+    template<uint32_t BAUDRATE, uint16_t MAX_ERROR = 25, uint32_t CPU_CLOCK = F_CPU>
+    using Baud = UsartBaud<BAUDRATE,MAX_ERROR,CPU_CLOCK>;
     
     bool transmitComplete() //! return true, if the last transmit was completed
     {
@@ -103,20 +135,241 @@ namespace SABA
 
       return udr();
     }
+
+    void writeData( uint8_t ch ) //! write the data register without waiting
+    {
+      SFREG<_UDR> udr;
+      udr= ch;
+    }
+
+    uint8_t readData() //! read the data register without waiting
+    {
+      SFREG<_UDR> udr;
+
+      return udr();
+    }
+
+    void enableReceiveInterrupt( bool enable ) //! enable or disable the receive complete interrupt
+    {
+      SFRBIT<_UCSRB,_RXCIE> rxcie;
+
+      rxcie= enable;
+    }
+
+    void enableDataRegisterEmptyInterrupt( bool enable ) //! enable or disable the data register empty interrupt
+    {
+      SFRBIT<_UCSRB,_UDRIE> udrie;
+
+      udrie= enable;
+    }
+
+  private:
+
+    void initialize(uint16_t ubrr, bool u2x)
+    {
+      SFREG<_UCSRA> ucsra;
+      SFREG<_UCSRB> ucsrb;
+      SFREG<_UCSRC> ucsrc;
+      SFREG<_UBRRL> ubrrl;
+      SFREG<_UBRRH> ubrrh;
+
+      ubrrl= (uint8_t)ubrr & (uint8_t)0xff;
+      ubrrh= ubrr >> 8;
+      ucsra= u2x ? BIT(_U2X) : 0;
+      ucsrb= BIT(_RXEN)|BIT(_TXEN);
+
+// Atmega 8
+#ifdef URSEL
+      ucsrc= BIT(URSEL) | BIT(UCSZ0) | BIT(UCSZ1);
+#else
+      ucsrc= BIT(_UCSZ0) | BIT(_UCSZ1);
+#endif
+    }
+  };
+
+
+  //! what a BufferedUsart does, if a byte is written into a full transmit buffer
+  enum OverflowPolicy
+  {
+    OverflowBlock,      //!< wait until the interrupt has sent a byte
+    OverflowDrop,       //!< drop the new byte
+    OverflowOverwrite   //!< drop the oldest byte in the buffer
   };
 
+  // \brief Interrupt driven Usart with receive and transmit ring buffers
+  /** 
+  The BufferedUsart extends one of the USARTx typedefs. putch() only writes into the transmit buffer, the data register
+  empty interrupt sends it. The receive interrupt fills the receive buffer. Both buffers are SpscFifo, so there is no cli/sei
+  needed. The application has to call the interrupt methods from the USART ISRs.
+  @tparam USART the Usart class, e.g. SABA::USART0
+  @tparam RX_SIZE the receive buffer size, a power of two up to 128
+  @tparam TX_SIZE the transmit buffer size, a power of two up to 128
+  @tparam POLICY the OverflowPolicy, if the transmit buffer is full. OverflowBlock needs enabled interrupts.
+
+  Usage:
+  ~~~{.c}
+  SABA::BufferedUsart<SABA::USART0,32,64,SABA::OverflowDrop> usart(57600);
+
+  ISR(USART_RX_vect)
+  {
+    usart.receiveInterrupt();
+  }
+
+  ISR(USART_UDRE_vect)
+  {
+    usart.dataRegisterEmptyInterrupt();
+  }
+
+  while(usart.available())
+    cmdline.appendChar(usart.read());
+  ~~~ 
+  */
+  template <class USART, uint8_t RX_SIZE, uint8_t TX_SIZE, OverflowPolicy POLICY = OverflowBlock>
+  class BufferedUsart : public USART
+  {
+  public:
+
+    BufferedUsart(uint32_t baudrate) : USART(baudrate) //! initializes the Usart and enables the receive interrupt
+    {
+      USART::enableReceiveInterrupt(true);
+    }
+
+    template<uint32_t BAUDRATE, uint16_t MAX_ERROR, uint32_t CPU_CLOCK>
+    BufferedUsart(UsartBaud<BAUDRATE,MAX_ERROR,CPU_CLOCK> baud) : USART(baud) //! initializes the Usart with a compile time baudrate and enables the receive interrupt
+    {
+      USART::enableReceiveInterrupt(true);
+    }
+
+    bool putch( uint8_t ch ) //! writes the byte into the transmit buffer, returns false, if it was dropped
+    {
+      if( !txFifo.push(ch) )
+      {
+        if( POLICY == OverflowBlock )
+        {
+          // the interrupt has to drain the buffer
+          USART::enableDataRegisterEmptyInterrupt(true);
+          while( !txFifo.push(ch) )
+            ;
+        }
+        else if( POLICY == OverflowOverwrite )
+        {
+          // the interrupt is the only consumer, while it is disabled the oldest byte can be removed here
+          USART::enableDataRegisterEmptyInterrupt(false);
+          txFifo.pop();
+          txFifo.push(ch);
+          ++transmitOverflowCount;
+        }
+        else
+        {
+          ++transmitOverflowCount;
+          return false;
+        }
+      }
+
+      USART::enableDataRegisterEmptyInterrupt(true);
+
+      return true;
+    }
+
+    uint8_t write( const uint8_t *data, uint8_t length ) //! writes a block into the transmit buffer, enables the interrupt once, returns the number of bytes not dropped
+    {
+      uint8_t written= 0;
+      while( written < length && txFifo.push(data[written]) )
+        ++written;
+
+      if( written == length )
+      {
+        USART::enableDataRegisterEmptyInterrupt(true);
+        return written;
+      }
+
+      // a full buffer is handled by putch and the overflow policy, the interrupt has to run meanwhile
+      USART::enableDataRegisterEmptyInterrupt(true);
+
+      uint8_t accepted= written;
+      for(;written < length;written++)
+      {
+        if( putch(data[written]) )
+          ++accepted;
+      }
+
+      return accepted;
+    }
+
+    void flush() //! waits until the transmit buffer is empty
+    {
+      while( !txFifo.isEmpty() )
+        ;
+    }
+
+    uint8_t available() //! return the number of received bytes in the receive buffer
+    {
+      return rxFifo.available();
+    }
+
+    uint8_t read() //! return the next received byte, 0 if the receive buffer is empty
+    {
+      return rxFifo.pop();
+    }
+
+    bool receiverComplete() //! return true, if there is a received byte in the receive buffer
+    {
+      return !rxFifo.isEmpty();
+    }
+
+    uint8_t getch() //! wait until a byte was received, then return it
+    {
+      uint8_t ch;
+      while( !rxFifo.pop(ch) )
+        ;
+
+      return ch;
+    }
+
+    uint8_t receiveOverflows() //! the number of received bytes lost, because the receive buffer was full
+    {
+      return receiveOverflowCount;
+    }
+
+    uint8_t transmitOverflows() //! the number of bytes dropped or overwritten, because the transmit buffer was full
+    {
+      return transmitOverflowCount;
+    }
+
+    void receiveInterrupt() //! call from the receive complete ISR
+    {
+      if( !rxFifo.push(USART::readData()) )
+        ++receiveOverflowCount;
+    }
+
+    void dataRegisterEmptyInterrupt() //! call from the data register empty ISR
+    {
+      uint8_t ch;
+      if( txFifo.pop(ch) )
+        USART::writeData(ch);
+      else
+        USART::enableDataRegisterEmptyInterrupt(false);
+    }
+
+  private:
+
+    SpscFifo<uint8_t,RX_SIZE> rxFifo;
+    SpscFifo<uint8_t,TX_SIZE> txFifo;
+    volatile uint8_t receiveOverflowCount = 0;
+    uint8_t transmitOverflowCount = 0;
+  };
 
 #ifdef UDR
   //! Atmega 8 
-  typedef Usart<(SFRA)&UDR,(SFRA)&UCSRA,(SFRA)&UCSRB,(SFRA)&UCSRC,(SFRA)&UBRRL,(SFRA)&UBRRH,RXEN,TXEN,UCSZ0,UCSZ1,TXC,RXC,UDRE> USART0;
+  typedef Usart<(SFRA)&UDR,(SFRA)&UCSRA,(SFRA)&UCSRB,(SFRA)&UCSRC,(SFRA)&UBRRL,(SFRA)&UBRRH,RXEN,TXEN,UCSZ0,UCSZ1,TXC,RXC,UDRE,RXCIE,UDRIE,U2X> USART0;
 #endif
 #ifdef UDR0
   //! Atmega xx8
-  typedef Usart<(SFRA)&UDR0,(SFRA)&UCSR0A,(SFRA)&UCSR0B,(SFRA)&UCSR0C,(SFRA)&UBRR0L,(SFRA)&UBRR0H,RXEN0,TXEN0,UCSZ00,UCSZ01,TXC0,RXC0,UDRE0> USART0;
+  typedef Usart<(SFRA)&UDR0,(SFRA)&UCSR0A,(SFRA)&UCSR0B,(SFRA)&UCSR0C,(SFRA)&UBRR0L,(SFRA)&UBRR0H,RXEN0,TXEN0,UCSZ00,UCSZ01,TXC0,RXC0,UDRE0,RXCIE0,UDRIE0,U2X0> USART0;
 #endif
 #ifdef UDR1
 //! Atmega xx8
-typedef Usart<(SFRA)&UDR1,(SFRA)&UCSR1A,(SFRA)&UCSR1B,(SFRA)&UCSR1C,(SFRA)&UBRR1L,(SFRA)&UBRR1H,RXEN1,TXEN1,UCSZ10,UCSZ11,TXC1,RXC1,UDRE1> USART1;
+typedef Usart<(SFRA)&UDR1,(SFRA)&UCSR1A,(SFRA)&UCSR1B,(SFRA)&UCSR1C,(SFRA)&UBRR1L,(SFRA)&UBRR1H,RXEN1,TXEN1,UCSZ10,UCSZ11,TXC1,RXC1,UDRE1,RXCIE1,UDRIE1,U2X1> USART1;
 #endif
 }
 
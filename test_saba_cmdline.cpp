@@ -0,0 +1,541 @@
+/*
+ * test_saba_cmdline.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the lines are typed into a CmdLine and the called commands and the output are checked,
+ * the integer converters are fuzzed against a 64 bit reference, the binary mode runs a Monitor command
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_cmdline.h"
+#include "saba_monitor.h"
+
+static char text[256];
+static uint16_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  if( textLength < sizeof(text) - 1 )
+    text[textLength++]= ch;
+  text[textLength]= 0;
+}
+
+static char executed;
+static uint16_t argument;
+
+static bool execute(char c)
+{
+  executed= c;
+
+  return c == 'X';
+}
+
+typedef SABA::CmdReader<uint8_t,40> Reader;
+
+static bool commandGo(Reader& reader)
+{
+  executed= 'g';
+  argument= reader.nextHex<uint16_t>();
+
+  return reader();
+}
+
+static bool commandStop(Reader& reader)
+{
+  executed= 's';
+
+  return true;
+}
+
+static bool commandStep(Reader& reader)
+{
+  executed= 't';
+
+  return true;
+}
+
+const char helpGo[] PROGMEM = "address";
+const char helpStop[] PROGMEM = "stop";
+
+constexpr SABA::Command<uint8_t,40> commands[] PROGMEM =
+{
+  { "go", &commandGo, helpGo, false },
+  { "step", &commandStep, nullptr, false },
+  { "stop", &commandStop, helpStop, false }
+};
+static_assert(SABA::commandsSorted(commands), "commands must be sorted by name");
+
+constexpr SABA::Command<uint8_t,40> unsorted[] =
+{
+  { "go", &commandGo, nullptr, false },
+  { "abc", &commandGo, nullptr, false }
+};
+static_assert(!SABA::commandsSorted(unsorted), "commandsSorted");
+
+typedef SABA::CmdLine<uint8_t,40,&textPutch,SABA::OStream,execute> TextCmdLine;
+
+template<class CMDLINE> static void type(CMDLINE& cmdline, const char *line)
+{
+  executed= 0;
+  textLength= 0;
+  while(*line)
+    cmdline.appendChar(*line++);
+}
+
+void testCmdLine_table()
+{
+  TextCmdLine cmdline(commands);
+
+  type(cmdline, "go 1a2b\r");
+  SABA_EQUAL( executed, 'g');
+  SABA_EQUAL( argument, 0x1a2b);
+
+  type(cmdline, "  stop\r");
+  SABA_EQUAL( executed, 's');
+  type(cmdline, "step\r");
+  SABA_EQUAL( executed, 't');
+
+  // a handler returning false prints the error
+  type(cmdline, "go xyz\r");
+  SABA_EQUAL( executed, 'g');
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+
+  // prefixes and unknown names are passed to execute
+  type(cmdline, "sto\r");
+  SABA_EQUAL( executed, 's');
+  type(cmdline, "X 12\r");
+  SABA_EQUAL( executed, 'X');
+  SABA_EQUAL( strstr(text, "???") == nullptr, true);
+  type(cmdline, "\r");
+  SABA_EQUAL( executed, 0);
+
+  type(cmdline, "help\r");
+  SABA_EQUAL( executed, 0);
+  SABA_EQUAL( strcmp(text, "help\r\ngo      address\r\nstep\r\nstop    stop\r\n"), 0);
+}
+
+void testCmdLine_search()
+{
+  // all names of a large table are found, the neighbours are not
+  static SABA::Command<uint8_t,40> large[60];
+  uint8_t found= 0;
+
+  for(uint8_t i=0;i < 60;i++)
+  {
+    large[i].name[0]= 'a' + i / 10;
+    large[i].name[1]= '0' + i % 10;
+    large[i].name[2]= 0;
+    large[i].handler= &commandStep;
+    large[i].help= nullptr;
+  }
+
+  TextCmdLine cmdline(large);
+  for(uint8_t i=0;i < 60;i++)
+  {
+    char line[5]= { large[i].name[0], large[i].name[1], '\r', 0 };
+    type(cmdline, line);
+    if( executed == 't' )
+      ++found;
+
+    line[1]= 'x';
+    type(cmdline, line);
+    if( executed == 't' )
+      ++found;
+  }
+
+  SABA_EQUAL( found, 60);
+}
+
+static bool commandArgs(Reader& reader)
+{
+  SABA::CmdArgs<3> args;
+  uint16_t address;
+  int8_t offset;
+
+  executed= 'a';
+  if( !reader.tokenize(args) || args.count() != 3 || !args[0].toInteger(address) || !args[1].toInteger(offset, int8_t(-10), int8_t(10)) )
+    return false;
+
+  argument= address + offset;
+
+  return args[2].quoted && args[2].equals(PSTR("a b"));
+}
+
+static bool commandNext(Reader& reader)
+{
+  uint8_t b= reader.nextDec<uint8_t>();
+  int16_t w= reader.nextHex<int16_t>();
+
+  executed= 'n';
+  argument= b + w;
+
+  return reader();
+}
+
+void testCmdLine_tokenize()
+{
+  constexpr SABA::Command<uint8_t,40> table[] =
+  {
+    { "args", &commandArgs, nullptr, false },
+    { "next", &commandNext, nullptr, false }
+  };
+  TextCmdLine cmdline(table);
+
+  type(cmdline, "args 0x1000 -3 \"a b\"\r");
+  SABA_EQUAL( executed, 'a');
+  SABA_EQUAL( argument, 0x1000 - 3);
+  SABA_EQUAL( strstr(text, "???") == nullptr, true);
+
+  // out of range, too many arguments, quote not closed
+  type(cmdline, "args 0x1000 11 \"a b\"\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+  type(cmdline, "args 1 2 \"a b\" 4\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+  type(cmdline, "args 1 2 \"a b\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+
+  type(cmdline, "next 255 7fff\r");
+  SABA_EQUAL( argument, 255 + 0x7fff);
+  SABA_EQUAL( strstr(text, "???") == nullptr, true);
+  type(cmdline, "next 256 0\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+  type(cmdline, "next 1 8000\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+}
+
+// the reference converter, the numbers are short enough for 64 bit
+static bool reference(const char *text, uint8_t length, bool isSigned, int64_t min, int64_t max, int64_t& value)
+{
+  uint8_t i= 0;
+  bool negative= isSigned && length > 0 && text[0] == '-';
+  if( negative )
+    i= 1;
+
+  int base= 10;
+  if( length - i > 2 && text[i] == '0' && (text[i + 1] == 'x' || text[i + 1] == 'X') )
+  {
+    base= 16;
+    i += 2;
+  }
+
+  if( i >= length )
+    return false;
+
+  int64_t result= 0;
+  for(;i < length;i++)
+  {
+    char ch= text[i];
+    int digit;
+    if( ch >= '0' && ch <= '9' )
+      digit= ch - '0';
+    else if( base == 16 && ch >= 'a' && ch <= 'f' )
+      digit= ch - 'a' + 10;
+    else if( base == 16 && ch >= 'A' && ch <= 'F' )
+      digit= ch - 'A' + 10;
+    else
+      return false;
+
+    result= result * base + digit;
+  }
+
+  value= negative ? -result : result;
+
+  return value >= min && value <= max;
+}
+
+template<typename T> static uint32_t fuzz(int64_t min, int64_t max, uint32_t count)
+{
+  static const char chars[]= "0123456789abcdefABCDEFxX- g";
+  uint32_t errors= 0;
+  char text[16];
+
+  for(uint32_t n=0;n < count;n++)
+  {
+    uint8_t length= 0;
+    switch( rand() % 4 )
+    {
+      case 0: // random characters
+        length= 1 + rand() % 8;
+        for(uint8_t i=0;i < length;i++)
+          text[i]= chars[rand() % (sizeof(chars) - 1)];
+        break;
+      case 1: // decimal near the limits
+        length= snprintf(text, sizeof(text), "%lld", (long long)((rand() & 1 ? min : max) + rand() % 5 - 2));
+        break;
+      case 2: // hex near the limits
+        {
+          int64_t v= (rand() & 1 ? min : max) + rand() % 5 - 2;
+          length= snprintf(text, sizeof(text), v < 0 ? "-0x%llx" : "0x%llX", (unsigned long long)(v < 0 ? -v : v));
+        }
+        break;
+      default: // random decimal or hex
+        length= snprintf(text, sizeof(text), rand() & 1 ? "%d" : "0x%x", rand() - RAND_MAX / 2);
+        break;
+    }
+
+    SABA::CmdArg arg= { text, length, false };
+    T value= 0;
+    int64_t expected= 0;
+    bool ok= arg.toInteger(value);
+    if( ok != reference(text, length, min < 0, min, max, expected) || (ok && value != expected) )
+      ++errors;
+  }
+
+  return errors;
+}
+
+void testCmdLine_converters()
+{
+  srand(2);
+
+  SABA_EQUAL( fuzz<uint8_t>(0, 0xff, 200000), 0);
+  SABA_EQUAL( fuzz<int8_t>(-0x80, 0x7f, 200000), 0);
+  SABA_EQUAL( fuzz<uint16_t>(0, 0xffff, 200000), 0);
+  SABA_EQUAL( fuzz<int16_t>(-0x8000, 0x7fff, 200000), 0);
+  SABA_EQUAL( fuzz<uint32_t>(0, 0xffffffffLL, 200000), 0);
+  SABA_EQUAL( fuzz<int32_t>(-0x80000000LL, 0x7fffffff, 200000), 0);
+
+  SABA::CmdArg arg= { "-128", 4, false };
+  int8_t i8;
+  SABA_EQUAL( arg.toInteger(i8), true);
+  SABA_EQUAL( i8, -128);
+  SABA_EQUAL( arg.toInteger(i8, int8_t(-100), int8_t(100)), false);
+  arg.quoted= true;
+  SABA_EQUAL( arg.toInteger(i8), false);
+
+  // the limits are derived from any integer type
+  SABA_EQUAL( SABA::IntLimits<char>::max, uint8_t(char(-1) < 0 ? 0x7f : 0xff));
+  SABA_EQUAL( SABA::IntLimits<signed char>::max, 0x7f);
+  SABA_EQUAL( SABA::IntLimits<unsigned int>::max, uint32_t(~0U));
+
+  arg= { "65", 2, false };
+  char c;
+  SABA_EQUAL( arg.toInteger(c), true);
+  SABA_EQUAL( c, 'A');
+  arg= { "65536", 5, false };
+  unsigned short us;
+  SABA_EQUAL( arg.toInteger(us), false);
+}
+
+static bool commandAdd(Reader& reader)
+{
+  uint16_t a= reader.nextHex<uint16_t>();
+  uint8_t b= reader.nextDec<uint8_t>();
+
+  executed= '+';
+  if( reader.binary() )
+    reader.result(uint16_t(a + b));
+  else
+    SABA::OStream<&textPutch>() << SABA::hex << uint16_t(a + b);
+
+  return reader();
+}
+
+static uint8_t frame[48];
+static uint8_t frameLength;
+
+static void framePutch(uint8_t ch)
+{
+  frame[frameLength++]= ch;
+}
+
+// encodes the request into frame
+static uint8_t request(const uint8_t *payload, uint8_t length)
+{
+  SABA::FrameTransport<&framePutch,40> encoder;
+
+  frameLength= 0;
+  encoder.sendFrame(payload, length);
+
+  return frameLength;
+}
+
+// sends the frame, the byte at lost is skipped
+template<class CMDLINE> static void send(CMDLINE& cmdline, uint8_t length, uint8_t lost= 0xff)
+{
+  executed= 0;
+  textLength= 0;
+  for(uint8_t i=0;i < length;i++)
+    if( i != lost )
+      cmdline.appendChar(char(frame[i]));
+}
+
+// decodes the response in text, the payload is copied into response
+static uint8_t response[24];
+static uint8_t responseLength;
+
+static bool responseValid()
+{
+  SABA::FrameTransport<&framePutch,24> decoder;
+  bool valid= false;
+
+  for(uint16_t i=0;i < textLength;i++)
+    valid= decoder.receive(uint8_t(text[i])) && i == textLength - 1;
+
+  responseLength= decoder.frameLength();
+  memcpy(response, decoder.frame(), responseLength);
+
+  return valid;
+}
+
+static uint8_t resets;
+
+// the LoopProfiler interface, with constant values
+class FakeProfiler
+{
+  public:
+
+  static constexpr uint8_t BUCKETS = 2;
+
+  static void reset() { resets++; }
+  static uint16_t minimum() { return 0x0102; }
+  static uint16_t maximum() { return 0x0506; }
+  static uint16_t average() { return 0x0304; }
+  static uint32_t perSecond() { return 0x0708090aUL; }
+  static uint16_t bucketCount(uint8_t i) { return i; }
+};
+
+typedef SABA::Monitor<uint8_t,40,SABA::OStream,&textPutch> TestMonitor;
+
+void testCmdLine_binary()
+{
+  constexpr SABA::Command<uint8_t,40> table[] =
+  {
+    { "add", &commandAdd, nullptr, true },
+    { "go", &commandGo, nullptr, true },
+    { "profile", &TestMonitor::profile<FakeProfiler>, nullptr, true },
+    { "stop", &commandStop, nullptr, false }
+  };
+  TextCmdLine cmdline(table);
+  uint8_t length;
+
+  type(cmdline, "add 1000 5\r");
+  SABA_EQUAL( strcmp(text, "add 1000 5\r\n1005"), 0);
+
+  // other escape sequences are not consumed, the cursor up key is typed as ESC [ A
+  type(cmdline, "\x1b[A\r");
+  SABA_EQUAL( strcmp(text, "[A\r\n^\r\n???\r\n"), 0);
+
+  type(cmdline, "\x1b\x02");
+  SABA_EQUAL( textLength, 0);
+
+  // add 0x1234 + 0x20, no echo, the result low byte first
+  static const uint8_t add[]= { 0, 0x34, 0x12, 0x20 };
+  length= request(add, sizeof(add));
+  send(cmdline, length);
+  SABA_EQUAL( executed, '+');
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( responseLength, 4);
+  SABA_EQUAL( response[0], 0);
+  SABA_EQUAL( response[1], SABA::CmdOk);
+  SABA_EQUAL( response[2], 0x54);
+  SABA_EQUAL( response[3], 0x12);
+  uint8_t addLength= length;
+  uint8_t addResponseLength= uint8_t(textLength);
+
+  // missing argument, unknown command, a command without binary support
+  length= request(add, 2);
+  send(cmdline, length);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( response[1], SABA::CmdFailed);
+
+  static const uint8_t unknown[]= { 7 };
+  length= request(unknown, sizeof(unknown));
+  send(cmdline, length);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( response[1], SABA::CmdUnknown);
+
+  static const uint8_t stop[]= { 3 };
+  length= request(stop, sizeof(stop));
+  send(cmdline, length);
+  SABA_EQUAL( executed, 0);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( response[1], SABA::CmdUnknown);
+
+  // a damaged request or a lost byte drops the request, the 0 delimiter synchronizes the next one
+  length= request(add, sizeof(add));
+  frame[2] ^= 1;
+  send(cmdline, length);
+  SABA_EQUAL( executed, 0);
+  SABA_EQUAL( textLength, 0);
+
+  length= request(add, sizeof(add));
+  send(cmdline, length, 3);
+  SABA_EQUAL( executed, 0);
+  SABA_EQUAL( textLength, 0);
+
+  send(cmdline, length);
+  SABA_EQUAL( executed, '+');
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( response[1], SABA::CmdOk);
+
+  // carriage return and 0 bytes are arguments
+  static const uint8_t go[]= { 1, 13, 0 };
+  length= request(go, sizeof(go));
+  send(cmdline, length);
+  SABA_EQUAL( executed, 'g');
+  SABA_EQUAL( argument, 13);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( response[1], SABA::CmdOk);
+
+  // a Monitor command, minimum, average, maximum and loops per second
+  static const uint8_t profile[]= { 2 };
+  static const uint8_t counts[]= { 0x02,0x01, 0x04,0x03, 0x06,0x05, 0x0a,0x09,0x08,0x07 };
+  length= request(profile, sizeof(profile));
+  send(cmdline, length);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( responseLength, 12);
+  SABA_EQUAL( response[0], 2);
+  SABA_EQUAL( response[1], SABA::CmdOk);
+  for(uint8_t i=0;i < sizeof(counts);i++)
+    SABA_EQUAL( response[2 + i], counts[i]);
+
+  static const uint8_t reset[]= { 2, 'R' };
+  resets= 0;
+  length= request(reset, sizeof(reset));
+  send(cmdline, length);
+  SABA_EQUAL( responseValid(), true);
+  SABA_EQUAL( responseLength, 2);
+  SABA_EQUAL( response[1], SABA::CmdOk);
+  SABA_EQUAL( resets, 1);
+
+  // back to text mode
+  length= request(go, 0);
+  send(cmdline, length);
+  SABA_EQUAL( textLength, 0);
+  type(cmdline, "go 12\r");
+  SABA_EQUAL( argument, 0x12);
+  SABA_EQUAL( strcmp(text, "go 12\r\n"), 0);
+
+  type(cmdline, "profile\r");
+  SABA_EQUAL( strcmp(text, "profile\r\nmin: 258 avg: 772 max: 1286 loops/s: 117967114\r\n<2: 1\r\n"), 0);
+  type(cmdline, "profile r\r");
+  SABA_EQUAL( resets, 2);
+
+  out << SABA::dec << PSTR("  add command, text: ") << uint8_t(sizeof("add 1234 32\r") - 1) << PSTR(" bytes, response ")
+    << uint8_t(sizeof("add 1234 32\r\n1254") - 1) << PSTR(" bytes, binary: ") << addLength
+    << PSTR(" bytes, response ") << addResponseLength << PSTR(" bytes") << SABA::endl;
+}
+
+void testCmdLine()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting CmdLine Tests") << SABA::endl;
+
+  testCmdLine_table();
+  testCmdLine_search();
+  testCmdLine_tokenize();
+  testCmdLine_converters();
+  testCmdLine_binary();
+
+  out << SABA::dec << PSTR("  CmdLine Tests Finished") << SABA::endl;
+}
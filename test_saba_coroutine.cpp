@@ -0,0 +1,262 @@
+/*
+ * test_saba_coroutine.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, a coroutine awaiting a Fifo and a delay, the LcdText initialization with a simulated I2C master,
+ * putch calls chained by the callbacks,
+ * the ticker is defined in test_saba_timing.cpp
+ */
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_coroutine.h"
+#include "saba_fifo.h"
+#include "saba_i2clcd.h"
+
+// completes each transaction after latency polls, records the written bytes
+class TestMaster : public SABA::I2C::I2CMaster
+{
+  public:
+
+  virtual bool startWriteAndRead(uint8_t address, uint8_t bytesToWrite, uint8_t *writeBuffer, uint8_t bytesToRead, uint8_t *readBuffer, SABA::I2C::DONE_FUNC doneFunc_= nullptr, void* env_= nullptr)
+  {
+    if( polls != 0 )
+      return false;
+
+    cmd.address= address;
+    cmd.bytesToWrite= bytesToWrite;
+    cmd.writeBuffer= writeBuffer;
+    cmd.bytesToRead= bytesToRead;
+    cmd.readBuffer= readBuffer;
+    cmd.error= transactions == failAt ? 0x20 : 0;
+    doneFunc= doneFunc_;
+    env= env_;
+
+    for(uint8_t i=0;i < bytesToWrite;i++)
+      written[writtenLength++]= writeBuffer[i];
+
+    transactions++;
+    polls= latency;
+    return true;
+  }
+
+  virtual void continueWriteAndRead(SABA::I2C::DONE_FUNC doneFunc_= nullptr)
+  {
+  }
+
+  virtual bool operator () ()
+  {
+    if( polls != 0 && --polls == 0 && doneFunc != nullptr )
+      doneFunc(env, &cmd);
+
+    return polls != 0;
+  }
+
+  SABA::I2C::CMD cmd;
+  SABA::I2C::DONE_FUNC doneFunc= nullptr;
+  void *env= nullptr;
+  uint8_t polls= 0;
+  uint8_t latency= 2;
+  uint8_t transactions= 0;
+  uint8_t failAt= 0xff;
+  uint8_t written[64];
+  uint8_t writtenLength= 0;
+};
+
+static SABA::Fifo<uint8_t,uint8_t,4> fifo;
+static SABA::Coroutine co;
+static SABA::Timing::SingleDelay<uint8_t> delay;
+static uint8_t received[8];
+static uint8_t receivedLength;
+
+static bool receive()
+{
+  SABA_CO_BEGIN(co);
+  for(;;)
+  {
+    SABA_CO_AWAIT(co, !fifo.isEmpty());
+    received[receivedLength++]= fifo.pop();
+    if( received[receivedLength-1] == 0 )
+      SABA_CO_EXIT(co);
+
+    SABA_CO_YIELD(co);
+    SABA_CO_DELAY(co, delay, 3);
+  }
+  SABA_CO_END(co);
+}
+
+void testCoroutine_await()
+{
+  receivedLength= 0;
+
+  SABA_EQUAL( receive(), false);
+  SABA_EQUAL( co.isStarted(), true);
+  SABA_EQUAL( receivedLength, 0);
+
+  fifo.push(1);
+  fifo.push(2);
+  fifo.push(0);
+  SABA_EQUAL( receive(), false);
+  SABA_EQUAL( receivedLength, 1);
+
+  // the yield, then the delay
+  SABA_EQUAL( receive(), false);
+  SABA_EQUAL( receive(), false);
+  SABA::Timing::ticker += 2;
+  SABA_EQUAL( receive(), false);
+  SABA_EQUAL( receivedLength, 1);
+
+  SABA::Timing::ticker += 1;
+  SABA_EQUAL( receive(), false);
+  SABA_EQUAL( receivedLength, 2);
+  SABA_EQUAL( received[1], 2);
+
+  SABA_EQUAL( receive(), false);
+  SABA::Timing::ticker += 3;
+  SABA_EQUAL( receive(), true);
+  SABA_EQUAL( receivedLength, 3);
+  SABA_EQUAL( co.isStarted(), false);
+}
+
+static uint8_t initCount;
+static uint8_t errorCode;
+
+static void initReturn(void *env)
+{
+  initCount++;
+}
+
+static void errorReturn(uint8_t error)
+{
+  errorCode= error;
+}
+
+static const char *chain;
+static uint8_t chained;
+
+// prints the next character of chain, a line feed sends home, env is the display
+static void putchNext(void *env)
+{
+  SABA::I2C::LcdText<true> *lcd= (SABA::I2C::LcdText<true> *)env;
+
+  ++chained;
+  if( *chain == '\n' )
+  {
+    chain++;
+    SABA_EQUAL( lcd->home(&putchNext, env), true);
+  }
+  else if( *chain != 0 )
+  {
+    SABA_EQUAL( lcd->putch(uint8_t(*chain++), &putchNext, env), true);
+  }
+}
+
+// cyclic calls until the display is not busy, the ticker is incremented every 4 calls
+static uint16_t runLcd(SABA::I2C::LcdText<true>& lcd)
+{
+  uint16_t ticks= 0;
+  for(uint16_t i=0;lcd.isBusy() && i < 4000;i++)
+  {
+    lcd.cyclic();
+    if( (i & 3) == 3 )
+    {
+      ++SABA::Timing::ticker;
+      ticks++;
+    }
+  }
+
+  return ticks;
+}
+
+void testCoroutine_lcd()
+{
+  TestMaster master;
+  SABA::I2C::LcdText<true> lcd(master, 0x4e);
+
+  initCount= 0;
+  errorCode= 0;
+
+  lcd.initialize(&initReturn, &errorReturn);
+  SABA_EQUAL( lcd.isBusy(), true);
+  SABA_EQUAL( master.transactions, 1);
+
+  uint16_t ticks= runLcd(lcd);
+  SABA_EQUAL( lcd.isBusy(), false);
+  SABA_EQUAL( lcd.isInitialized(), true);
+  SABA_EQUAL( initCount, 1);
+  SABA_EQUAL( errorCode, 0);
+  SABA_EQUAL( ticks >= 111, true);
+  SABA_EQUAL( ticks < 120, true);
+
+  // the mask, 4 nibbles and 4 bytes
+  static const uint8_t expected[]= { 0x00, 0x34,0x30, 0x34,0x30, 0x34,0x30, 0x24,0x20,
+    0x24,0x20,0x84,0x80, 0x04,0x00,0xc4,0xc0, 0x04,0x00,0x14,0x10, 0x04,0x00,0x64,0x60 };
+  SABA_EQUAL( master.writtenLength, uint8_t(sizeof(expected)));
+  for(uint8_t i=0;i < sizeof(expected);i++)
+    SABA_EQUAL( master.written[i], expected[i]);
+
+  // putch sets RS, a command clears it
+  master.writtenLength= 0;
+  SABA_EQUAL( lcd.putch('A'), true);
+  SABA_EQUAL( lcd.home(), false);
+  runLcd(lcd);
+  SABA_EQUAL( lcd.home(&initReturn), true);
+  runLcd(lcd);
+  SABA_EQUAL( initCount, 2);
+  SABA_EQUAL( master.writtenLength, 8);
+  SABA_EQUAL( master.written[0], 0x45);
+  SABA_EQUAL( master.written[3], 0x11);
+  SABA_EQUAL( master.written[4], 0x04);
+  SABA_EQUAL( master.written[7], 0x20);
+
+  // the callback prints the next character, each one is written once
+  master.writtenLength= 0;
+  chain= "BCD";
+  chained= 0;
+  SABA_EQUAL( lcd.putch('A', &putchNext, &lcd), true);
+  runLcd(lcd);
+  SABA_EQUAL( chained, 4);
+  SABA_EQUAL( master.writtenLength, 16);
+  for(uint8_t i=0;i < 4;i++)
+  {
+    SABA_EQUAL( master.written[i * 4], 0x45);
+    SABA_EQUAL( master.written[i * 4 + 2], uint8_t(((i + 1) << 4) | 0x05));
+  }
+
+  // the master completes at the first poll, the started command is not run twice
+  master.latency= 1;
+  master.writtenLength= 0;
+  chain= "\nB";
+  chained= 0;
+  SABA_EQUAL( lcd.putch('A', &putchNext, &lcd), true);
+  runLcd(lcd);
+  SABA_EQUAL( chained, 3);
+  SABA_EQUAL( master.writtenLength, 12);
+  SABA_EQUAL( master.written[4], 0x04);
+  SABA_EQUAL( master.written[6], 0x24);
+  SABA_EQUAL( master.written[8], 0x45);
+  master.latency= 2;
+
+  // an error stops the initialization
+  master.failAt= master.transactions + 3;
+  lcd.initialize(&initReturn, &errorReturn);
+  runLcd(lcd);
+  SABA_EQUAL( lcd.isBusy(), false);
+  SABA_EQUAL( errorCode, 0x20);
+  SABA_EQUAL( initCount, 2);
+  SABA_EQUAL( master.transactions, master.failAt + 1);
+}
+
+void testCoroutine()
+{
+  out << SABA::dec << PSTR("  Starting Coroutine Tests") << SABA::endl;
+
+  testCoroutine_await();
+  testCoroutine_lcd();
+
+  out << PSTR("  Coroutine Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,247 @@
+/*
+ * test_saba_fifo.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the stress test needs a thread library
+ * the block benchmark prints per element and block times in ns
+ */
+
+#include <thread>
+#include <chrono>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_fifo.h"
+
+void testSpscFifo_pushPop()
+{
+  SABA::SpscFifo<uint8_t,4> fifo;
+
+  SABA_EQUAL( fifo.isEmpty(), true);
+  SABA_EQUAL( fifo.pop(), 0);
+
+  SABA_EQUAL( fifo.push(1), true);
+  SABA_EQUAL( fifo.push(2), true);
+  SABA_EQUAL( fifo.push(3), true);
+  SABA_EQUAL( fifo.push(4), true);
+  SABA_EQUAL( fifo.isFull(), true);
+  SABA_EQUAL( fifo.push(5), false);
+  SABA_EQUAL( fifo.available(), 4);
+
+  SABA_EQUAL( fifo.pop(), 1);
+  SABA_EQUAL( fifo.push(5), true);
+  SABA_EQUAL( fifo.pop(), 2);
+  SABA_EQUAL( fifo.pop(), 3);
+  SABA_EQUAL( fifo.pop(), 4);
+  SABA_EQUAL( fifo.pop(), 5);
+  SABA_EQUAL( fifo.isEmpty(), true);
+}
+
+void testSpscFifo_wrap()
+{
+  SABA::SpscFifo<uint8_t,8> fifo;
+
+  // run the free running indices several times through 255
+  for(uint16_t i=0;i < 1000;i++)
+  {
+    SABA_EQUAL( fifo.push(uint8_t(i)), true);
+    SABA_EQUAL( fifo.push(uint8_t(i+1)), true);
+    SABA_EQUAL( fifo.pop(), uint8_t(i));
+    SABA_EQUAL( fifo.pop(), uint8_t(i+1));
+    SABA_EQUAL( fifo.available(), 0);
+  }
+}
+
+void testSpscFifo_stress()
+{
+  static constexpr uint32_t COUNT = 1000000;
+  SABA::SpscFifo<uint32_t,16> fifo;
+  uint32_t received= 0;
+  uint32_t errors= 0;
+
+  std::thread producer([&fifo]()
+  {
+    for(uint32_t i=0;i < COUNT;)
+    {
+      if( fifo.push(i) )
+        ++i;
+      else
+        std::this_thread::yield();
+    }
+  });
+
+  std::thread consumer([&fifo,&received,&errors]()
+  {
+    uint32_t value;
+    while( received < COUNT )
+    {
+      if( fifo.pop(value) )
+      {
+        if( value != received )
+          ++errors;
+        ++received;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  SABA_EQUAL( received, COUNT);
+  SABA_EQUAL( errors, 0);
+  SABA_EQUAL( fifo.isEmpty(), true);
+}
+
+void testFifo_block()
+{
+  SABA::Fifo<uint8_t,uint8_t,10> fifo;
+  uint8_t data[16];
+  uint8_t result[16];
+
+  for(uint8_t i=0;i < sizeof(data);i++)
+    data[i]= i + 1;
+
+  SABA_EQUAL( fifo.pushBlock(data, 6), 6);
+  SABA_EQUAL( fifo.popBlock(result, 4), 4);
+  SABA_EQUAL( result[0], 1);
+  SABA_EQUAL( result[3], 4);
+
+  // wraps around, only 8 are free
+  SABA_EQUAL( fifo.pushBlock(data, 16), 8);
+  SABA_EQUAL( fifo.isFull(), true);
+  SABA_EQUAL( fifo.pushBlock(data, 1), 0);
+
+  SABA_EQUAL( fifo.popBlock(result, 16), 10);
+  SABA_EQUAL( result[0], 5);
+  SABA_EQUAL( result[1], 6);
+  SABA_EQUAL( result[2], 1);
+  SABA_EQUAL( result[9], 8);
+  SABA_EQUAL( fifo.isEmpty(), true);
+  SABA_EQUAL( fifo.popBlock(result, 1), 0);
+}
+
+void testFifo_reserveCommit()
+{
+  SABA::Fifo<uint8_t,uint8_t,8> fifo;
+  uint8_t *dest;
+  const uint8_t *src;
+
+  SABA_EQUAL( fifo.reserve(dest, 5), 5);
+  for(uint8_t i=0;i < 5;i++)
+    dest[i]= 'a' + i;
+  fifo.commit(5);
+
+  SABA_EQUAL( fifo.peekContiguous(src), 5);
+  SABA_EQUAL( src[0], 'a');
+  fifo.consume(3);
+
+  // only the span up to the wrap point is returned
+  SABA_EQUAL( fifo.reserve(dest, 8), 3);
+  fifo.commit(3);
+  SABA_EQUAL( fifo.reserve(dest, 8), 3);
+  fifo.commit(3);
+  SABA_EQUAL( fifo.isFull(), true);
+  SABA_EQUAL( fifo.reserve(dest, 8), 0);
+
+  SABA_EQUAL( fifo.peekContiguous(src), 5);
+  SABA_EQUAL( src[0], 'd');
+  fifo.consume(5);
+  SABA_EQUAL( fifo.peekContiguous(src), 3);
+  fifo.consume(3);
+  SABA_EQUAL( fifo.isEmpty(), true);
+}
+
+void testFifo_statistics()
+{
+  SABA::Fifo<uint8_t,uint8_t,4,true> fifo;
+  uint8_t data[6]= { 1, 2, 3, 4, 5, 6 };
+
+  // disabled statistics need no memory
+  SABA_EQUAL( uint8_t(sizeof(SABA::Fifo<uint8_t,uint8_t,4>)), 4 + 3);
+
+  fifo.registerStatistics(PSTR("TEST"));
+  SABA_EQUAL( SABA::FifoStatistics<true>::first() == &fifo, true);
+  SABA_EQUAL( fifo.size(), 4);
+
+  // a second registration does not link the FIFO to itself
+  fifo.registerStatistics(PSTR("TEST"));
+  SABA_EQUAL( SABA::FifoStatistics<true>::first() == &fifo, true);
+  SABA_EQUAL( fifo.next() == &fifo, false);
+
+  fifo.push(1);
+  fifo.push(2);
+  fifo.pop();
+  SABA_EQUAL( fifo.highWater(), 2);
+  SABA_EQUAL( fifo.pushCount(), 2);
+
+  SABA_EQUAL( fifo.pushBlock(data, 6), 3);
+  SABA_EQUAL( fifo.push(7), false);
+  SABA_EQUAL( fifo.highWater(), 4);
+  SABA_EQUAL( fifo.pushFailures(), 4);
+  SABA_EQUAL( fifo.pushCount(), 5);
+
+  // reading does not reset the statistics
+  fifo.popBlock(data, 6);
+  SABA_EQUAL( fifo.highWater(), 4);
+  SABA_EQUAL( fifo.pushCount(), 5);
+
+  SABA::FifoStatistics<true>::first()= fifo.next();
+}
+
+void benchmarkFifo_block()
+{
+  static constexpr uint32_t ROUNDS = 100000;
+  static SABA::Fifo<uint8_t,uint8_t,200> fifo;
+  static uint8_t frame[64];
+  volatile uint8_t sink= 0;
+
+  auto start= std::chrono::steady_clock::now();
+  for(uint32_t r=0;r < ROUNDS;r++)
+  {
+    for(uint8_t i=0;i < sizeof(frame);i++)
+      fifo.push(frame[i]);
+    for(uint8_t i=0;i < sizeof(frame);i++)
+      frame[i]= fifo.pop();
+    sink= sink + frame[r & 63];
+  }
+  auto single= std::chrono::steady_clock::now() - start;
+
+  start= std::chrono::steady_clock::now();
+  for(uint32_t r=0;r < ROUNDS;r++)
+  {
+    fifo.pushBlock(frame, sizeof(frame));
+    fifo.popBlock(frame, sizeof(frame));
+    sink= sink + frame[r & 63];
+  }
+  auto block= std::chrono::steady_clock::now() - start;
+
+  out << SABA::dec << PSTR("  64 byte frame push/pop: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(single).count() / ROUNDS)
+    << PSTR(" ns, pushBlock/popBlock: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(block).count() / ROUNDS)
+    << PSTR(" ns") << SABA::endl;
+}
+
+void testFifo()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Fifo Tests") << SABA::endl;
+
+  testSpscFifo_pushPop();
+  testSpscFifo_wrap();
+  testSpscFifo_stress();
+  testFifo_block();
+  testFifo_reserveCommit();
+  testFifo_statistics();
+  benchmarkFifo_block();
+
+  out << SABA::dec << PSTR("  Fifo Tests Finished") << SABA::endl;
+}
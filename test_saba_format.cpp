@@ -0,0 +1,144 @@
+/*
+ * test_saba_format.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, SABA_FORMAT is compared with the equivalent << chain of Monitor::dumpTimer8,
+ * the benchmark prints the time per line in ns and the FLASH bytes of the string literals
+ */
+
+#include <string.h>
+#include <chrono>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_format.h"
+
+static char text[128];
+static uint8_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  if( textLength < sizeof(text) - 1 )
+    text[textLength++]= ch;
+  text[textLength]= 0;
+}
+
+typedef SABA::OStream<&textPutch> TextStream;
+
+static void dumpTimer8Chain( char ti, uint8_t tccra, uint8_t tccrb, uint8_t tcnt, uint8_t ocra, uint8_t ocrb)
+{
+  TextStream ostr;
+  ostr << SABA::hex
+    << PSTR("TCCR") << ti << PSTR("A: ") << tccra
+    << PSTR(" TCCR") << ti << PSTR("B: ") << tccrb
+    << PSTR(" TCNT") << ti << ':' << ' ' << tcnt
+    << PSTR(" OCR") << ti << PSTR("A: ") << ocra
+    << PSTR(" OCR") << ti << PSTR("B: ") << ocrb << SABA::endl;
+}
+
+static void dumpTimer8Format( char ti, uint8_t tccra, uint8_t tccrb, uint8_t tcnt, uint8_t ocra, uint8_t ocrb)
+{
+  TextStream ostr;
+  SABA_FORMAT(ostr, "TCCR{}A: {:x} TCCR{}B: {:x} TCNT{}: {:x} OCR{}A: {:x} OCR{}B: {:x}\r\n",
+    ti, tccra, ti, tccrb, ti, tcnt, ti, ocra, ti, ocrb);
+}
+
+void testFormat_parser()
+{
+  static constexpr const char *format= "a{}bc{:x}{:d}";
+
+  static_assert(SABA::Format::count(format) == 3, "count");
+  static_assert(SABA::Format::open(format, 0) == 1, "open");
+  static_assert(SABA::Format::open(format, 1) == 5, "open");
+  static_assert(SABA::Format::literal(format, 1) == 3, "literal");
+  static_assert(SABA::Format::spec(format, 0) == 0, "spec");
+  static_assert(SABA::Format::spec(format, 1) == 'x', "spec");
+  static_assert(SABA::Format::spec(format, 2) == 'd', "spec");
+  static_assert(SABA::Format::text(format, 1) == 3, "text");
+  static_assert(SABA::Format::text(format, 3) == 3, "text");
+  static_assert(SABA::Format::textChar(format, 0) == 'a', "textChar");
+  static_assert(SABA::Format::textChar(format, 2) == 'c', "textChar");
+  static_assert(SABA::Format::balanced(format), "balanced");
+  static_assert(!SABA::Format::balanced("a{b"), "balanced");
+  static_assert(!SABA::Format::balanced("a}b"), "balanced");
+  static_assert(!SABA::Format::balanced("a{{}b"), "balanced");
+  static_assert(SABA::Format::accepts('x', SABA::Format::Category<uint16_t>::value), "accepts");
+  static_assert(!SABA::Format::accepts('x', SABA::Format::Category<char>::value), "accepts");
+  static_assert(!SABA::Format::accepts(0, SABA::Format::Category<float>::value), "accepts");
+}
+
+void testFormat_output()
+{
+  TextStream ostr;
+  char chain[128];
+
+  textLength= 0;
+  dumpTimer8Chain('0', 0x03, 0x04, 0xa5, 0x7f, 0x00);
+  strcpy(chain, text);
+
+  textLength= 0;
+  dumpTimer8Format('0', 0x03, 0x04, 0xa5, 0x7f, 0x00);
+  SABA_EQUAL( strcmp(text, chain), 0);
+
+  // the base is restored after a {:x} or {:d}
+  ostr << SABA::dec;
+  textLength= 0;
+  SABA_FORMAT(ostr, "{:x} {} {:d} {} {}", uint16_t(0x1234), uint8_t(10), int16_t(-5), PSTR("pgm"), true);
+  ostr << uint8_t(11);
+  SABA_EQUAL( strcmp(text, "1234 10 -5 pgm true11"), 0);
+
+  textLength= 0;
+  SABA_FORMAT(ostr, "no placeholder");
+  SABA_EQUAL( strcmp(text, "no placeholder"), 0);
+}
+
+void benchmarkFormat()
+{
+  static constexpr uint32_t COUNT = 200000;
+  volatile uint8_t value= 0x12;
+
+  auto start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    textLength= 0;
+    dumpTimer8Chain('0', value, value, uint8_t(i), value, value);
+  }
+  auto chain= std::chrono::steady_clock::now() - start;
+
+  start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    textLength= 0;
+    dumpTimer8Format('0', value, value, uint8_t(i), value, value);
+  }
+  auto format= std::chrono::steady_clock::now() - start;
+
+  // the string literals of the << chain, each with its terminating 0
+  static const uint8_t chainFlash= sizeof("TCCR") + sizeof("A: ") + sizeof(" TCCR") + sizeof("B: ") + sizeof(" TCNT")
+    + sizeof(" OCR") + sizeof("A: ") + sizeof(" OCR") + sizeof("B: ");
+  // the literals stored by SABA_FORMAT, without the placeholders
+  static const uint8_t formatFlash= sizeof("TCCRA: TCCRB: TCNT: OCRA: OCRB: \r\n");
+
+  out << SABA::dec << PSTR("  dumpTimer8 << chain: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(chain).count() / COUNT)
+    << PSTR(" ns, 9 strings ") << chainFlash
+    << PSTR(" bytes, SABA_FORMAT: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(format).count() / COUNT)
+    << PSTR(" ns, 1 string ") << formatFlash << PSTR(" bytes") << SABA::endl;
+}
+
+void testFormat()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Format Tests") << SABA::endl;
+
+  testFormat_parser();
+  testFormat_output();
+  benchmarkFormat();
+
+  out << SABA::dec << PSTR("  Format Tests Finished") << SABA::endl;
+}
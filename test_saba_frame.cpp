@@ -0,0 +1,182 @@
+/*
+ * test_saba_frame.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host loopback test, the sent bytes are collected in a wire buffer and fed back to the receiver
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_frame.h"
+
+static uint8_t wire[1024];
+static uint16_t wireLength;
+
+static void wirePutch(uint8_t ch)
+{
+  if( wireLength < sizeof(wire) )
+    wire[wireLength++]= ch;
+}
+
+static uint8_t received[64];
+static uint8_t receivedLength;
+static uint16_t receivedCount;
+
+static void frameReceived(const uint8_t *data, uint8_t length)
+{
+  memcpy(received, data, length);
+  receivedLength= length;
+  ++receivedCount;
+}
+
+typedef SABA::FrameTransport<&wirePutch,64,&frameReceived> Transport;
+
+static void loopback(Transport& transport)
+{
+  for(uint16_t i=0;i < wireLength;i++)
+    transport.receive(wire[i]);
+
+  wireLength= 0;
+}
+
+void testFrame_crc()
+{
+  // CRC-16/MCRF4XX check value
+  uint16_t crc= 0xffff;
+  for(const char *p= "123456789";*p;p++)
+    crc= SABA::crc16Update(crc, *p);
+
+  SABA_EQUAL( crc, 0x6f91);
+}
+
+void testFrame_loopback()
+{
+  Transport transport;
+  uint8_t data[64];
+
+  for(uint8_t length=0;length <= sizeof(data);length++)
+  {
+    for(uint8_t i=0;i < length;i++)
+      data[i]= (i % 3) ? uint8_t(i * 37) : 0;
+
+    receivedCount= 0;
+    transport.sendFrame(data, length);
+
+    // no 0 inside the frame
+    SABA_EQUAL( memchr(wire, 0, wireLength - 1) == nullptr, true);
+    SABA_EQUAL( wire[wireLength - 1], 0);
+
+    loopback(transport);
+    SABA_EQUAL( receivedCount, 1);
+    SABA_EQUAL( receivedLength, length);
+    SABA_EQUAL( memcmp(received, data, length), 0);
+  }
+
+  SABA_EQUAL( transport.errors(), 0);
+}
+
+void testFrame_tooLong()
+{
+  Transport transport;
+  uint8_t data[255];
+
+  // the receiver could not take it, 254 and 255 would wrap the frame length
+  memset(data, 0x55, sizeof(data));
+  wireLength= 0;
+  transport.sendFrame(data, 65);
+  SABA_EQUAL( wireLength, 0);
+  transport.sendFrame(data, 254);
+  SABA_EQUAL( wireLength, 0);
+  transport.sendFrame(data, 255);
+  SABA_EQUAL( wireLength, 0);
+}
+
+void testFrame_corruption()
+{
+  Transport transport;
+  uint8_t data[32];
+  uint16_t wrongFrames= 0;
+
+  srand(1);
+  for(uint16_t n=0;n < 2000;n++)
+  {
+    for(uint8_t i=0;i < sizeof(data);i++)
+      data[i]= uint8_t(rand());
+
+    receivedCount= 0;
+    transport.sendFrame(data, sizeof(data));
+
+    // flip some bits in the frame, never the delimiter
+    uint8_t flips= 1 + (n & 3);
+    for(uint8_t i=0;i < flips;i++)
+      wire[rand() % (wireLength - 1)] ^= uint8_t(1 << (rand() & 7));
+
+    loopback(transport);
+    if( receivedCount != 0 && memcmp(received, data, sizeof(data)) != 0 )
+      ++wrongFrames;
+
+    // the next correct frame is received again
+    receivedCount= 0;
+    transport.sendFrame(data, sizeof(data));
+    loopback(transport);
+    SABA_EQUAL( receivedCount, 1);
+    SABA_EQUAL( memcmp(received, data, sizeof(data)), 0);
+  }
+
+  SABA_EQUAL( wrongFrames, 0);
+  SABA_EQUAL( transport.errors() != 0, true);
+}
+
+static uint16_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  ++textLength;
+}
+
+void benchmarkFrame()
+{
+  Transport transport;
+  SABA::OStream<&textPutch> text;
+  uint8_t data[32];
+
+  for(uint8_t i=0;i < sizeof(data);i++)
+    data[i]= i;
+
+  wireLength= 0;
+  transport.sendFrame(data, sizeof(data));
+
+  // the same payload as hex text, one byte and a blank per value
+  textLength= 0;
+  text << SABA::hex;
+  for(uint8_t i=0;i < sizeof(data);i++)
+    text << data[i] << ' ';
+  text << SABA::endl;
+
+  // 57600 baud, 10 bits per byte
+  out << SABA::dec << PSTR("  payload at 57600 baud, frame: ") << uint32_t(5760UL * sizeof(data) / wireLength)
+    << PSTR(" byte/s, hex text: ") << uint32_t(5760UL * sizeof(data) / textLength) << PSTR(" byte/s") << SABA::endl;
+
+  wireLength= 0;
+}
+
+void testFrame()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Frame Tests") << SABA::endl;
+
+  testFrame_crc();
+  testFrame_loopback();
+  testFrame_tooLong();
+  testFrame_corruption();
+  benchmarkFrame();
+
+  out << SABA::dec << PSTR("  Frame Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,81 @@
+/*
+ * test_saba_hexdump.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the dump is compared with the expected text
+ */
+
+#include <string.h>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_fifo.h"
+#include "saba_hexdump.h"
+
+static char text[512];
+static uint16_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  if( textLength < sizeof(text) - 1 )
+    text[textLength++]= ch;
+  text[textLength]= 0;
+}
+
+typedef SABA::OStream<&textPutch> TextStream;
+
+void testHexdump_rows()
+{
+  TextStream stream;
+  static uint8_t data[0x2010];
+
+  for(uint8_t i=0;i < 20;i++)
+    data[0x1ff8 + i]= uint8_t('0' + i);
+  data[0x1ff9]= 0;
+  data[0x1ffa]= 0x7f;
+
+  // the address is relative to the RamReader base
+  textLength= 0;
+  SABA::hexdump(stream, SABA::RamReader(data), 0x1ff8, 20);
+  SABA_EQUAL( strcmp(text,
+    "1FF8: 30 00 7F 33 34 35 36 37 38 39 3A 3B 3C 3D 3E 3F  0..3456789:;<=>?\r\n"
+    "2008: 40 41 42 43                                      @ABC\r\n"), 0);
+
+  textLength= 0;
+  SABA::hexdump(stream, SABA::RamReader(data), 0, 0);
+  SABA_EQUAL( textLength, 0);
+}
+
+void testHexdump_fifo()
+{
+  TextStream stream;
+  SABA::Fifo<uint8_t,uint8_t,8> fifo;
+
+  fifo.push('a');
+  fifo.push('b');
+  fifo.pop();
+
+  textLength= 0;
+  fifo.dumpFifo(stream);
+  SABA_EQUAL( strncmp(text, "WI: 02 RI: 01 AL: 01\r\n0000: 61 62", 33), 0);
+  SABA_EQUAL( textLength, 22 + 65);
+
+  // the FIFO is not changed
+  SABA_EQUAL( fifo.isEmpty(), false);
+  SABA_EQUAL( fifo.pop(), 'b');
+}
+
+void testHexdump()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Hexdump Tests") << SABA::endl;
+
+  testHexdump_rows();
+  testHexdump_fifo();
+
+  out << SABA::dec << PSTR("  Hexdump Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,170 @@
+/*
+ * test_saba_log.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the records and the table entries are checked byte by byte,
+ * the benchmark compares bytes and time per line with the SABA_FORMAT text, in cycles on x86 hosts
+ */
+
+#include <string.h>
+#include <chrono>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_log.h"
+
+static uint8_t wire[256];
+static uint16_t wireLength;
+
+static void wirePutch(uint8_t ch)
+{
+  if( wireLength < sizeof(wire) )
+    wire[wireLength++]= ch;
+}
+
+typedef SABA::DeferredLog<&wirePutch,32> Log;
+
+struct AdcFormat
+{
+  static constexpr const char *str() { return "adc {}: {:x}"; }
+};
+
+void testLog_record()
+{
+  Log log;
+
+  wireLength= 0;
+  SABA::Log::record<AdcFormat>(log, uint8_t(3), int16_t(-2));
+  log.drain();
+
+  typedef SABA::Log::Entry<AdcFormat, SABA::Format::MakeIndices<12>::type, uint8_t, int16_t> AdcEntry;
+  uint16_t id= uint16_t(uintptr_t(AdcEntry::str));
+
+  SABA_EQUAL( uint8_t(sizeof(AdcEntry::str)), 16);
+  SABA_EQUAL( memcmp(AdcEntry::str, "adc {}: {:x}\0Bh", 16), 0);
+
+  SABA_EQUAL( wireLength, 5);
+  SABA_EQUAL( wire[0], uint8_t(id));
+  SABA_EQUAL( wire[1], uint8_t(id >> 8));
+  SABA_EQUAL( wire[2], 3);
+  SABA_EQUAL( wire[3], 0xfe);
+  SABA_EQUAL( wire[4], 0xff);
+
+  // each call site has its own ID
+  wireLength= 0;
+  SABA_LOG(log, "a {} {} {}", uint32_t(0x12345678), true, 'c');
+  SABA_LOG(log, "no arguments");
+  log.drain();
+  SABA_EQUAL( wireLength, 2 + 4 + 1 + 1 + 2);
+  SABA_EQUAL( wire[2], 0x78);
+  SABA_EQUAL( wire[5], 0x12);
+  SABA_EQUAL( wire[6], 1);
+  SABA_EQUAL( wire[7], 'c');
+  SABA_EQUAL( wire[8] != wire[0] || wire[9] != wire[1], true);
+}
+
+void testLog_drop()
+{
+  Log log;
+
+  // 4 records of 7 bytes fit into 32 bytes, the 5th is dropped completely
+  wireLength= 0;
+  for(uint8_t i=0;i < 5;i++)
+    SABA_LOG(log, "{} {}", uint32_t(i), i);
+
+  SABA_EQUAL( log.drops(), 1);
+
+  log.drain(3);
+  SABA_EQUAL( wireLength, 3);
+  SABA_LOG(log, "{} {}", uint32_t(4), uint8_t(4));
+  SABA_EQUAL( log.drops(), 1);
+  log.drain();
+  SABA_EQUAL( wireLength, 35);
+  SABA_EQUAL( wire[34], 4);
+}
+
+static uint32_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  ++textLength;
+}
+
+static void nullPutch(uint8_t ch)
+{
+}
+
+// the time stamp counter on x86 hosts, nanoseconds otherwise
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_UNIT " cycles"
+static uint64_t timestamp()
+{
+  return __rdtsc();
+}
+#else
+#define BENCHMARK_UNIT " ns"
+static uint64_t timestamp()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+void benchmarkLog()
+{
+  static constexpr uint32_t BATCHES = 20000;
+  static constexpr uint8_t RECORDS = 14;   // 9 byte records in the 128 byte buffer
+  SABA::OStream<&textPutch> text;
+  SABA::DeferredLog<&nullPutch,128> log;
+  volatile uint8_t value= 0x12;
+  uint64_t format= 0, record= 0, drain= 0;
+
+  textLength= 0;
+  for(uint32_t b=0;b < BATCHES;b++)
+  {
+    uint64_t start= timestamp();
+    for(uint8_t i=0;i < RECORDS;i++)
+      SABA_FORMAT(text, "TCCR{}A: {:x} TCCR{}B: {:x} TCNT{}: {:x}\r\n", '1', value, '1', value, '1', uint16_t(i));
+    format += timestamp() - start;
+  }
+  uint8_t textBytes= uint8_t(textLength / (BATCHES * RECORDS));
+
+  // the call site and the drain are measured separately
+  for(uint32_t b=0;b < BATCHES;b++)
+  {
+    uint64_t start= timestamp();
+    for(uint8_t i=0;i < RECORDS;i++)
+      SABA_LOG(log, "TCCR{}A: {:x} TCCR{}B: {:x} TCNT{}: {:x}\r\n", '1', value, '1', value, '1', uint16_t(i));
+    uint64_t stored= timestamp();
+    log.drain();
+    drain += timestamp() - stored;
+    record += stored - start;
+  }
+  SABA_EQUAL( log.drops(), 0);
+
+  Log wireLog;
+  wireLength= 0;
+  SABA_LOG(wireLog, "TCCR{}A: {:x} TCCR{}B: {:x} TCNT{}: {:x}\r\n", '1', value, '1', value, '1', uint16_t(0));
+  wireLog.drain();
+
+  out << SABA::dec << PSTR("  log line, text: ") << uint32_t(format / (BATCHES * RECORDS))
+    << PSTR(BENCHMARK_UNIT " ") << textBytes << PSTR(" bytes, deferred: ") << uint32_t(record / (BATCHES * RECORDS))
+    << PSTR(BENCHMARK_UNIT " ") << wireLength << PSTR(" bytes, drain: ") << uint32_t(drain / (BATCHES * RECORDS))
+    << PSTR(BENCHMARK_UNIT) << SABA::endl;
+}
+
+void testLog()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Log Tests") << SABA::endl;
+
+  testLog_record();
+  testLog_drop();
+  benchmarkLog();
+
+  out << SABA::dec << PSTR("  Log Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,209 @@
+/*
+ * test_saba_monitor.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the Monitor memory and watch commands with a simulated data space and FLASH, the lines are typed into a CmdLine and the
+ * output is checked, the ticker is defined in test_saba_timing.cpp
+ */
+
+#include <string.h>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_monitor.h"
+
+static char text[256];
+static uint16_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  if( textLength < sizeof(text) - 1 )
+    text[textLength++]= ch;
+  text[textLength]= 0;
+}
+
+static uint8_t memory[0x100];
+static uint8_t flash[0x100];
+
+// the data space and the FLASH, the addresses wrap around at 0x100
+struct SimulatedMemory
+{
+  static uint8_t read(uint16_t address)
+  {
+    return memory[address & 0xff];
+  }
+
+  static void write(uint16_t address, uint8_t value)
+  {
+    memory[address & 0xff]= value;
+  }
+
+  static uint8_t readFlash(uint16_t address)
+  {
+    return flash[address & 0xff];
+  }
+
+  static uint16_t read16(uint16_t address)
+  {
+    return memory[address & 0xff] | (memory[(address + 1) & 0xff] << 8);
+  }
+};
+
+static bool execute(char c)
+{
+  return false;
+}
+
+typedef SABA::Monitor<uint8_t,40,SABA::OStream,&textPutch,4,SimulatedMemory> TestMonitor;
+typedef SABA::CmdLine<uint8_t,40,&textPutch,SABA::OStream,execute> TestCmdLine;
+
+static constexpr SABA::Command<uint8_t,40> commands[] =
+{
+  { "block", &TestMonitor::block, nullptr, false },
+  { "peek", &TestMonitor::peek, nullptr, false },
+  { "poke", &TestMonitor::poke, nullptr, false },
+  { "watch", &TestMonitor::watch, nullptr, false }
+};
+
+// types the line, the output without the echo is in text
+static void type(TestCmdLine& cmdline, const char *line)
+{
+  textLength= 0;
+  text[0]= 0;
+  while(*line)
+    cmdline.appendChar(*line++);
+
+  const char *output= strchr(text, '\n');
+  if( output != nullptr )
+    memmove(text, output + 1, strlen(output));
+  textLength= strlen(text);
+}
+
+static void poll(uint16_t ticks)
+{
+  textLength= 0;
+  text[0]= 0;
+  SABA::Timing::ticker += ticks;
+  TestMonitor::watchPoll();
+}
+
+void testMonitor_watch()
+{
+  TestCmdLine cmdline(commands);
+
+  memset(memory, 0, sizeof(memory));
+  SABA::Timing::ticker= 0xfffe;
+
+  // address 0 is a valid address
+  type(cmdline, "watch + 0\r");
+  SABA_EQUAL( strcmp(text, "period: 0000 0000:01\r\n"), 0);
+  type(cmdline, "watch + 10 2\r");
+  SABA_EQUAL( strcmp(text, "period: 0000 0000:01 0010:02\r\n"), 0);
+  type(cmdline, "watch + 20 3\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+
+  // no period, no sample
+  poll(100);
+  SABA_EQUAL( textLength, 0);
+
+  // all values are printed once after setting the period, the period spans the wrap around of the ticker
+  memory[0]= 0x12;
+  memory[0x10]= 0x56;
+  memory[0x11]= 0x34;
+  type(cmdline, "watch p 5\r");
+  SABA_EQUAL( strcmp(text, "period: 0005 0000:01 0010:02\r\n"), 0);
+  poll(4);
+  SABA_EQUAL( textLength, 0);
+  poll(1);
+  SABA_EQUAL( strcmp(text, "~0000:12 0010:3456\r\n"), 0);
+
+  // only the changed values
+  poll(5);
+  SABA_EQUAL( textLength, 0);
+  memory[0x11]= 0x35;
+  poll(4);
+  SABA_EQUAL( textLength, 0);
+  poll(1);
+  SABA_EQUAL( strcmp(text, "~0010:3556\r\n"), 0);
+
+  // the same address changes the size, the entries are full
+  type(cmdline, "watch + 10 1\r");
+  type(cmdline, "watch + 30\r");
+  type(cmdline, "watch + 40\r");
+  SABA_EQUAL( strcmp(text, "period: 0005 0000:01 0010:01 0030:01 0040:01\r\n"), 0);
+  type(cmdline, "watch + 50\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+  poll(5);
+  SABA_EQUAL( strcmp(text, "~0010:56 0030:00 0040:00\r\n"), 0);
+
+  // remove one, then all
+  type(cmdline, "watch - 0\r");
+  SABA_EQUAL( strcmp(text, "period: 0005 0010:01 0030:01 0040:01\r\n"), 0);
+  memory[0]= 0x13;
+  memory[0x30]= 0x99;
+  poll(5);
+  SABA_EQUAL( strcmp(text, "~0030:99\r\n"), 0);
+
+  type(cmdline, "watch -\r");
+  SABA_EQUAL( strcmp(text, "period: 0005\r\n"), 0);
+  memory[0x30]= 0x98;
+  poll(5);
+  SABA_EQUAL( textLength, 0);
+
+  // period 0 stops
+  type(cmdline, "watch + 30\r");
+  type(cmdline, "watch p 0\r");
+  poll(5);
+  SABA_EQUAL( textLength, 0);
+  type(cmdline, "watch -\r");
+}
+
+void testMonitor_memory()
+{
+  TestCmdLine cmdline(commands);
+
+  for(uint16_t i=0;i < sizeof(flash);i++)
+    flash[i]= uint8_t(0xff - i);
+  memset(memory, 0, sizeof(memory));
+
+  type(cmdline, "poke 20 41 42 7f\r");
+  SABA_EQUAL( textLength, 0);
+  SABA_EQUAL( memory[0x20], 0x41);
+  SABA_EQUAL( memory[0x21], 0x42);
+  SABA_EQUAL( memory[0x22], 0x7f);
+  type(cmdline, "poke 20\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+
+  // the space is read once, upper case too
+  type(cmdline, "peek d 20 3\r");
+  SABA_EQUAL( strcmp(text, "0020: 41 42 7F                                         AB.\r\n"), 0);
+  type(cmdline, "peek F 10\r");
+  SABA_EQUAL( strcmp(text, "0010: EF                                               .\r\n"), 0);
+  type(cmdline, "peek x 10\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+
+  // raw and as hex digits
+  type(cmdline, "block d 20 3 h\r");
+  SABA_EQUAL( strcmp(text, "41427F\r\n"), 0);
+  type(cmdline, "block f 0 2 H\r");
+  SABA_EQUAL( strcmp(text, "FFFE\r\n"), 0);
+  type(cmdline, "block D 21 2\r");
+  SABA_EQUAL( textLength, 2);
+  SABA_EQUAL( strncmp(text, "B\x7f", 2), 0);
+  type(cmdline, "block d 21\r");
+  SABA_EQUAL( strstr(text, "???") != nullptr, true);
+}
+
+void testMonitor()
+{
+  out << SABA::dec << PSTR("  Starting Monitor Tests") << SABA::endl;
+
+  testMonitor_watch();
+  testMonitor_memory();
+
+  out << PSTR("  Monitor Tests Finished") << SABA::endl;
+}
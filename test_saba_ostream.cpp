@@ -0,0 +1,334 @@
+/*
+ * test_saba_ostream.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the decimal and fixed point output is compared with snprintf, the string and tee streams with the expected text,
+ * the benchmark prints the time per number in ns
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+static char text[32];
+static uint8_t textLength;
+
+static void textPutch(uint8_t ch)
+{
+  if( textLength < sizeof(text) - 1 )
+    text[textLength++]= ch;
+  text[textLength]= 0;
+}
+
+typedef SABA::OStream<&textPutch> TextStream;
+
+static TextStream textStream;
+
+template<typename T> static bool compare(T value, const char *format, uint8_t width, bool left)
+{
+  char expected[32];
+
+  textLength= 0;
+  textStream.width(width);
+  if( left )
+    textStream << SABA::left;
+  else
+    textStream << SABA::right;
+  textStream << SABA::dec << value;
+
+  snprintf(expected, sizeof(expected), format, left ? -int(width) : int(width), value);
+
+  return strcmp(text, expected) == 0;
+}
+
+void testOStream_dec16()
+{
+  uint32_t errors= 0;
+
+  for(uint32_t i=0;i <= 0xffff;i++)
+  {
+    if( !compare(uint16_t(i), "%*u", 0, false) )
+      ++errors;
+    if( !compare(int16_t(i), "%*d", 0, false) )
+      ++errors;
+    if( !compare(uint16_t(i), "%*u", 7, false) )
+      ++errors;
+    if( !compare(int16_t(i), "%*d", 7, true) )
+      ++errors;
+  }
+
+  SABA_EQUAL( errors, 0);
+}
+
+void testOStream_dec32()
+{
+  uint32_t errors= 0;
+  uint32_t value= 0;
+
+  // every number of digits and its boundaries, then pseudo random values
+  for(uint32_t power=1;power <= 1000000000;power *= 10)
+  {
+    for(int8_t d=-2;d <= 2;d++)
+    {
+      value= power * 9 + d;
+      if( !compare(uint32_t(power + d), "%*u", 0, false) || !compare(uint32_t(value), "%*u", 12, false) )
+        ++errors;
+      if( !compare(int32_t(power + d), "%*d", 0, false) || !compare(int32_t(-(power + d)), "%*d", 12, true) )
+        ++errors;
+    }
+  }
+
+  for(uint32_t i=0;i < 2000000;i++)
+  {
+    value= value * 1664525 + 1013904223;
+    if( !compare(uint32_t(value), "%*u", 0, false) || !compare(uint32_t(value >> (i & 31)), "%*u", 11, i & 1) )
+      ++errors;
+    if( !compare(int32_t(value), "%*d", 0, false) || !compare(int32_t(value), "%*d", 11, i & 1) )
+      ++errors;
+  }
+
+  SABA_EQUAL( compare(uint32_t(0xffffffff), "%*u", 0, false), true);
+  SABA_EQUAL( compare(int32_t(0x80000000), "%*d", 0, false), true);
+  SABA_EQUAL( compare(int16_t(0x8000), "%*d", 0, false), true);
+
+  // the old 32 bit path checked the sign of the lower 16 bits only
+  SABA_EQUAL( compare(int32_t(0x8000), "%*d", 0, false), true);
+  SABA_EQUAL( compare(int32_t(-65536), "%*d", 0, false), true);
+
+  SABA_EQUAL( errors, 0);
+}
+
+// the former division based conversion, as reference for the benchmark
+static void printDecDivision(uint32_t dw)
+{
+  bool p= false;
+  for(uint32_t div= 1000000000;div > 0; div /= 10)
+  {
+    if( p || div == 1 || dw >= div)
+    {
+      textPutch( '0' + ( dw / div ) );
+      dw %= div;
+      p= true;
+    }
+  }
+}
+
+void benchmarkOStream_dec32()
+{
+  static constexpr uint32_t COUNT = 1000000;
+  volatile uint32_t value= 12345;
+
+  auto start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    textLength= 0;
+    printDecDivision(value + i * 4099);
+  }
+  auto division= std::chrono::steady_clock::now() - start;
+
+  textStream.width(0);
+  textStream << SABA::dec;
+  start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    textLength= 0;
+    textStream << uint32_t(value + i * 4099);
+  }
+  auto subtraction= std::chrono::steady_clock::now() - start;
+
+  out << SABA::dec << PSTR("  32 bit decimal, division: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(division).count() / COUNT)
+    << PSTR(" ns, subtraction: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(subtraction).count() / COUNT)
+    << PSTR(" ns") << SABA::endl;
+}
+
+static uint8_t blocks;
+static uint8_t blockText[64];
+static uint8_t blockTextLength;
+
+static void blockPutblock(const uint8_t *data, uint8_t length)
+{
+  memcpy(blockText + blockTextLength, data, length);
+  blockTextLength += length;
+  ++blocks;
+}
+
+template<class STREAM> static void writeLines(STREAM& stream)
+{
+  blocks= 0;
+  blockTextLength= 0;
+  stream << SABA::dec << PSTR("A: ") << uint16_t(1234) << SABA::endl;
+  stream << PSTR("B: ") << true << SABA::endl;
+}
+
+void testOStream_buffered()
+{
+  SABA::BufferedOStream<&blockPutblock,16,SABA::LineBuffered> lineStream;
+  SABA::BufferedOStream<&blockPutblock,16,SABA::FullBuffered> fullStream;
+  SABA::BufferedOStream<&blockPutblock,16,SABA::Unbuffered> unbufferedStream;
+
+  writeLines(lineStream);
+  SABA_EQUAL( blocks, 2);
+  SABA_EQUAL( blockTextLength, 18);
+  SABA_EQUAL( memcmp(blockText, "A: 1234\r\nB: true\r\n", 18), 0);
+
+  // one block if the buffer is full, the rest on flush
+  writeLines(fullStream);
+  SABA_EQUAL( blocks, 1);
+  SABA_EQUAL( blockTextLength, 16);
+  fullStream.flush();
+  SABA_EQUAL( blocks, 2);
+  SABA_EQUAL( blockTextLength, 18);
+  SABA_EQUAL( memcmp(blockText, "A: 1234\r\nB: true\r\n", 18), 0);
+  fullStream.flush();
+  SABA_EQUAL( blocks, 2);
+
+  writeLines(unbufferedStream);
+  SABA_EQUAL( blocks, 18);
+  SABA_EQUAL( memcmp(blockText, "A: 1234\r\nB: true\r\n", 18), 0);
+}
+
+void testOStream_fixed()
+{
+  uint32_t errors= 0;
+  char expected[32];
+
+  // all Q8.8 values with all precisions and adjustments
+  for(uint8_t precision=0;precision <= 4;precision++)
+  {
+    textStream.precision(precision);
+    for(uint32_t i=0;i <= 0xffff;i++)
+    {
+      int16_t raw= int16_t(i);
+      uint8_t width= (i & 3) * 4;
+      bool left= i & 4;
+
+      textLength= 0;
+      textStream.width(width);
+      if( left )
+        textStream << SABA::left;
+      else
+        textStream << SABA::right;
+      textStream << SABA::Fixed<8,8>(raw);
+
+      snprintf(expected, sizeof(expected), "%*.*f", left ? -int(width) : int(width), int(precision), raw / 256.0);
+      if( strcmp(text, expected) != 0 )
+        ++errors;
+    }
+  }
+
+  // Q16.16 boundaries and Q1.15
+  textStream.width(0);
+  textStream.precision(4);
+  textLength= 0;
+  textStream << SABA::Fixed<16,16>(int32_t(0x80000000));
+  SABA_EQUAL( strcmp(text, "-32768.0000"), 0);
+  textLength= 0;
+  textStream << SABA::Fixed<16,16>(int32_t(0x7fffffff));
+  SABA_EQUAL( strcmp(text, "32768.0000"), 0);
+  textLength= 0;
+  textStream << SABA::Fixed<1,15>(int16_t(0x4000));
+  SABA_EQUAL( strcmp(text, "0.5000"), 0);
+  textStream.precision(9);
+  SABA_EQUAL( textStream.precision(2), 4);
+
+  SABA_EQUAL( errors, 0);
+}
+
+void testOStream_string()
+{
+  char line[17];
+  SABA::OStringStream lineStream(line, sizeof(line));
+  SABA::FixedOStringStream<8> fixedStream;
+
+  lineStream << SABA::dec << PSTR("T: ") << int16_t(-12) << ' ' << SABA::hex << uint8_t(0xab);
+  SABA_EQUAL( strcmp(lineStream.str(), "T: -12 AB"), 0);
+  SABA_EQUAL( lineStream.length(), 9);
+  SABA_EQUAL( lineStream.truncated(), false);
+
+  // the flags are kept after clear
+  lineStream.clear();
+  lineStream.width(4);
+  lineStream << uint16_t(0x1f) << SABA::endl;
+  SABA_EQUAL( strcmp(lineStream.str(), "001F\r\n"), 0);
+
+  // exactly 16 characters fit, the 17th is dropped
+  lineStream.clear();
+  lineStream << SABA::dec << PSTR("0123456789") << uint32_t(123456);
+  SABA_EQUAL( lineStream.length(), 16);
+  SABA_EQUAL( lineStream.truncated(), false);
+  lineStream << 'x';
+  SABA_EQUAL( lineStream.truncated(), true);
+  SABA_EQUAL( strcmp(lineStream.str(), "0123456789123456"), 0);
+
+  fixedStream.precision(1);
+  fixedStream << SABA::Fixed<8,8>(int16_t(0x0180)) << PSTR(" C") << true;
+  SABA_EQUAL( strcmp(fixedStream.str(), "1.5 Ctr"), 0);
+  SABA_EQUAL( fixedStream.truncated(), true);
+  SABA_EQUAL( memcmp(fixedStream.str(), "1.5 Ctr", fixedStream.length()), 0);
+}
+
+static char sinkText[3][32];
+static uint8_t sinkLength[3];
+
+template<uint8_t SINK> static void sinkPutch(uint8_t ch)
+{
+  if( sinkLength[SINK] < sizeof(sinkText[SINK]) - 1 )
+    sinkText[SINK][sinkLength[SINK]++]= ch;
+  sinkText[SINK][sinkLength[SINK]]= 0;
+}
+
+void testOStream_tee()
+{
+  typedef SABA::Sinks<&sinkPutch<0>, &sinkPutch<1>, &sinkPutch<2> > LogSinks;
+  SABA::OStream<&LogSinks::putch> allStream;
+  SABA::TeeOStream<LogSinks> log;
+
+  memset(sinkLength, 0, sizeof(sinkLength));
+  allStream << SABA::dec << uint8_t(42);
+  SABA_EQUAL( strcmp(sinkText[0], "42"), 0);
+  SABA_EQUAL( strcmp(sinkText[1], "42"), 0);
+  SABA_EQUAL( strcmp(sinkText[2], "42"), 0);
+
+  memset(sinkLength, 0, sizeof(sinkLength));
+  log.mask(1, SABA::SeverityError);
+  log.mask(2, SABA::SeverityWarning | SABA::SeverityError);
+
+  log.severity(SABA::SeverityInfo);
+  log << 'i';
+  log.severity(SABA::SeverityWarning);
+  log << 'w';
+  log.severity(SABA::SeverityError);
+  log << 'e';
+  log.mask(0, 0);
+  // an invalid sink is ignored
+  log.mask(3, 0);
+  log << 'x';
+
+  SABA_EQUAL( strcmp(sinkText[0], "iwe"), 0);
+  SABA_EQUAL( strcmp(sinkText[1], "ex"), 0);
+  SABA_EQUAL( strcmp(sinkText[2], "wex"), 0);
+}
+
+void testOStream()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting OStream Tests") << SABA::endl;
+
+  testOStream_dec16();
+  testOStream_dec32();
+  testOStream_buffered();
+  testOStream_fixed();
+  testOStream_string();
+  testOStream_tee();
+  benchmarkOStream_dec32();
+
+  out << SABA::dec << PSTR("  OStream Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,150 @@
+/*
+ * test_saba_profiler.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the LoopProfiler iterations are timed with a simulated timer counter, 1000 counts per tick,
+ * the ticker is defined in test_saba_timing.cpp
+ */
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_profiler.h"
+
+static constexpr uint16_t PERIOD = 1000;
+
+static uint16_t simulatedCount;
+static bool tickDuringRead;
+
+struct SimulatedCounter
+{
+  // with tickDuringRead the counter wraps and the overflow interrupt increments the ticker before it is read
+  static uint16_t count()
+  {
+    if( tickDuringRead )
+    {
+      tickDuringRead= false;
+      ++SABA::Timing::ticker;
+      simulatedCount= 0;
+    }
+
+    return simulatedCount;
+  }
+};
+
+typedef SABA::LoopProfiler<SimulatedCounter,PERIOD,100> Profiler;
+
+// an iteration at the time in counts
+static void iterationAt(uint64_t time)
+{
+  SABA::Timing::ticker= uint16_t(time / PERIOD);
+  simulatedCount= uint16_t(time % PERIOD);
+  Profiler::iteration();
+}
+
+// the time of a single iteration
+static uint16_t measure(uint64_t start, uint64_t end)
+{
+  Profiler::reset();
+  iterationAt(start);
+  iterationAt(end);
+  SABA_EQUAL( Profiler::minimum(), Profiler::maximum());
+
+  return Profiler::minimum();
+}
+
+void testProfiler_time()
+{
+  Profiler::reset();
+  SABA_EQUAL( Profiler::minimum(), 0xffff);
+  SABA_EQUAL( Profiler::maximum(), 0);
+
+  // within a tick, across one and several ticks, across the wrap around of the ticker
+  SABA_EQUAL( measure(100, 350), 250);
+  SABA_EQUAL( measure(900, 1100), 200);
+  SABA_EQUAL( measure(999, 3001), 2002);
+  SABA_EQUAL( measure(uint64_t(0xffff) * PERIOD + 500, uint64_t(0x10000) * PERIOD + 100), 600);
+
+  // saturated at 0xffff
+  SABA_EQUAL( measure(0, 0xffff), 0xffff);
+  SABA_EQUAL( measure(0, 0x10000), 0xffff);
+  SABA_EQUAL( measure(0, 70000000), 0xffff);
+
+  // the ticker is incremented, while the counter is read, both are read again
+  Profiler::reset();
+  iterationAt(500);
+  SABA::Timing::ticker= 0;
+  simulatedCount= 999;
+  tickDuringRead= true;
+  Profiler::iteration();
+  SABA_EQUAL( Profiler::minimum(), 500);
+}
+
+void testProfiler_second()
+{
+  Profiler::reset();
+  iterationAt(0);
+
+  // 250 iterations of 400 counts, the second ends with the last one
+  for(uint16_t i=1;i < 250;i++)
+    iterationAt(uint32_t(i) * 400);
+  SABA_EQUAL( Profiler::perSecond(), 0);
+  SABA_EQUAL( Profiler::average(), 0);
+
+  iterationAt(100000);
+  SABA_EQUAL( Profiler::perSecond(), 250);
+  SABA_EQUAL( Profiler::average(), 400);
+
+  // 200 iterations of 500 counts
+  for(uint16_t i=1;i <= 200;i++)
+    iterationAt(100000 + uint32_t(i) * 500);
+  SABA_EQUAL( Profiler::perSecond(), 200);
+  SABA_EQUAL( Profiler::average(), 500);
+  SABA_EQUAL( Profiler::minimum(), 400);
+  SABA_EQUAL( Profiler::maximum(), 500);
+  SABA_EQUAL( Profiler::bucketCount(9), 450);
+
+  // the histogram entries saturate
+  Profiler::reset();
+  for(uint32_t i=0;i < 70000;i++)
+    iterationAt(300000);
+  SABA_EQUAL( Profiler::bucketCount(0), 0xffff);
+  SABA_EQUAL( Profiler::minimum(), 0);
+}
+
+void testProfiler_bucket()
+{
+  SABA_EQUAL( Profiler::bucket(0), 0);
+  for(uint8_t i=1;i < Profiler::BUCKETS;i++)
+  {
+    SABA_EQUAL( Profiler::bucket(uint16_t(1UL << (i - 1))), i);
+    SABA_EQUAL( Profiler::bucket(uint16_t((1UL << i) - 1)), i);
+  }
+
+  // all values against a shift loop
+  uint32_t errors= 0;
+  for(uint32_t value=0;value <= 0xffff;value++)
+  {
+    uint8_t bits= 0;
+    for(uint32_t v=value;v != 0;v >>= 1)
+      bits++;
+
+    if( Profiler::bucket(uint16_t(value)) != bits )
+      ++errors;
+  }
+  SABA_EQUAL( errors, 0);
+}
+
+void testProfiler()
+{
+  out << SABA::dec << PSTR("  Starting Profiler Tests") << SABA::endl;
+
+  testProfiler_time();
+  testProfiler_second();
+  testProfiler_bucket();
+
+  out << PSTR("  Profiler Tests Finished") << SABA::endl;
+}
@@ -0,0 +1,573 @@
+/*
+ * test_saba_timing.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the Scheduler timers are compared with polled SingleDelay timers started at the same ticks,
+ * the 32 bit time is checked across the wrap around of the 16 bit ticker,
+ * the Clock timestamps are checked with a simulated timer, including the overflow race,
+ * the TicklessTimer1 deadlines with a simulated Timer1, including a match passed before it was enabled,
+ * the benchmark prints the main loop time per tick with 32 polled and 32 scheduled timers in ns
+ */
+
+#include <string.h>
+#include <chrono>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_timing.h"
+#include "saba_clock.h"
+#include "saba_tickless.h"
+
+volatile uint16_t SABA::Timing::ticker;
+SABA::Timing::Scheduler SABA::Timing::scheduler;
+
+static constexpr uint8_t TIMERS = 32;
+
+static uint8_t fired[TIMERS];
+static uint8_t firedCount;
+static uint16_t firedTick[TIMERS];
+
+static void recordCallback(void *env)
+{
+  uint8_t index= uint8_t(uintptr_t(env));
+
+  fired[firedCount++]= index;
+  firedTick[index]= SABA::Timing::ticker;
+}
+
+static void tick(uint16_t count = 1)
+{
+  for(;count != 0;count--)
+  {
+    ++SABA::Timing::ticker;
+    SABA::Timing::scheduler.cyclic();
+  }
+}
+
+void testTiming_order()
+{
+  SABA::Timing::ScheduledCallbackDelay timers[4];
+
+  firedCount= 0;
+  timers[0].start(30, (void *)0, recordCallback);
+  timers[1].start(10, (void *)1, recordCallback);
+  timers[2].start(20, (void *)2, recordCallback);
+  timers[3].start(10, (void *)3, recordCallback);
+  SABA_EQUAL( timers[0](), true);
+
+  tick(9);
+  SABA_EQUAL( firedCount, 0);
+  tick();
+  SABA_EQUAL( firedCount, 2);
+  SABA_EQUAL( fired[0], 1);
+  SABA_EQUAL( fired[1], 3);
+  SABA_EQUAL( timers[1](), false);
+
+  // stop the last one, the one before is still due at 20
+  timers[0].stop();
+  tick(20);
+  SABA_EQUAL( firedCount, 3);
+  SABA_EQUAL( fired[2], 2);
+  SABA_EQUAL( firedTick[2], uint16_t(SABA::Timing::ticker - 10));
+}
+
+void testTiming_late()
+{
+  SABA::Timing::ScheduledDelay delay;
+  SABA::Timing::ScheduledDelay first;
+
+  // the ticker advanced without cyclic, the delay starts at the current tick anyway
+  first.start(100);
+  SABA::Timing::ticker += 5;
+  delay.start(10);
+  tick(9);
+  SABA_EQUAL( delay.isRunning(), true);
+  SABA_EQUAL( delay(), false);
+  tick();
+  SABA_EQUAL( delay.isRunning(), false);
+  SABA_EQUAL( delay(), true);
+  SABA_EQUAL( delay(), false);
+
+  // several ticks between two calls of cyclic
+  SABA_EQUAL( first.isRunning(), true);
+  SABA::Timing::ticker += 84;
+  SABA::Timing::scheduler.cyclic();
+  SABA_EQUAL( first.isRunning(), true);
+  SABA::Timing::ticker += 1;
+  SABA::Timing::scheduler.cyclic();
+  SABA_EQUAL( first(), true);
+
+  // stop after done, operator() is false
+  delay.start(1);
+  tick();
+  delay.stop();
+  SABA_EQUAL( delay(), false);
+}
+
+void testTiming_scope()
+{
+  SABA::Timing::ScheduledCallbackDelay outer;
+
+  firedCount= 0;
+  outer.start(10, (void *)0, recordCallback);
+  {
+    // destroyed while running, it is not linked any more
+    SABA::Timing::ScheduledCallbackDelay inner;
+    SABA::Timing::ScheduledDelay delay;
+    inner.start(5, (void *)1, recordCallback);
+    delay.start(7);
+  }
+
+  tick(10);
+  SABA_EQUAL( firedCount, 1);
+  SABA_EQUAL( fired[0], 0);
+}
+
+static SABA::Timing::ScheduledCallbackDelay periodic;
+static uint8_t periodicCount;
+
+static void periodicCallback(void *env)
+{
+  ++periodicCount;
+  periodic.start(3, env, periodicCallback);
+}
+
+void testTiming_restart()
+{
+  periodicCount= 0;
+  periodic.start(3, nullptr, periodicCallback);
+
+  tick(30);
+  SABA_EQUAL( periodicCount, 10);
+
+  // several ticks processed at once, the callback restarts the delay at the current tick
+  SABA::Timing::ticker += 7;
+  SABA::Timing::scheduler.cyclic();
+  SABA_EQUAL( periodicCount, 11);
+  tick(2);
+  SABA_EQUAL( periodicCount, 11);
+  tick();
+  SABA_EQUAL( periodicCount, 12);
+
+  periodic.stop();
+  tick(10);
+  SABA_EQUAL( periodicCount, 12);
+}
+
+static SABA::Timing::ScheduledCallbackDelay slow;
+static SABA::Timing::ScheduledCallbackDelay next;
+
+static void slowCallback(void *env)
+{
+  // the callback takes 5 ticks
+  SABA::Timing::ticker += 5;
+}
+
+void testTiming_long()
+{
+  SABA::Timing::ScheduledDelay delay;
+
+  // no timer running, the ticker advanced without cyclic, the full 16 bit delay is still available
+  SABA::Timing::ticker += 0x8000;
+  delay.start(0xfff0);
+  tick(0xffef);
+  SABA_EQUAL( delay.isRunning(), true);
+  tick();
+  SABA_EQUAL( delay(), true);
+
+  // a timer due during a slow callback is called by the same cyclic
+  firedCount= 0;
+  slow.start(2, nullptr, slowCallback);
+  next.start(5, (void *)0, recordCallback);
+  tick(2);
+  SABA_EQUAL( firedCount, 1);
+  SABA_EQUAL( firedTick[0], uint16_t(SABA::Timing::ticker));
+  tick();
+  SABA_EQUAL( firedCount, 1);
+}
+
+void testTiming_compare()
+{
+  SABA::Timing::ScheduledDelay scheduled[TIMERS];
+  SABA::Timing::SingleDelay<uint16_t> polled[TIMERS];
+  uint32_t random= 1;
+  uint32_t errors= 0;
+
+  for(uint32_t i=0;i < 200000;i++)
+  {
+    random= random * 1664525 + 1013904223;
+    uint8_t index= uint8_t(random >> 8) % TIMERS;
+    uint16_t delay= uint16_t(random >> 16) % 300 + 1;
+
+    if( !polled[index].isRunning() )
+    {
+      polled[index].start(delay);
+      scheduled[index].start(delay);
+    }
+
+    if( (random & 0x100) != 0 )
+      tick();
+
+    for(uint8_t t=0;t < TIMERS;t++)
+      if( polled[t]() != scheduled[t]() )
+        ++errors;
+  }
+
+  for(uint8_t t=0;t < TIMERS;t++)
+    scheduled[t].stop();
+
+  SABA_EQUAL( errors, 0);
+}
+
+// the simulated timer: the counter and the overflow flag are derived from the time in counts since the start
+static uint64_t hardwareTime;
+static uint64_t servicedOverflows;
+static uint16_t simulatedTop;
+static bool simulatedAtTop;
+static uint8_t readAdvance;
+
+static uint64_t simulatedOverflows(uint64_t time)
+{
+  return simulatedAtTop ? (time + 1) / (simulatedTop + 1) : time / (simulatedTop + 1);
+}
+
+struct SimulatedCounter
+{
+  // the time passes by readAdvance counts, before the overflow flag is read
+  static uint16_t count()
+  {
+    uint16_t value= uint16_t(hardwareTime % (simulatedTop + 1));
+    hardwareTime += readAdvance;
+
+    return value;
+  }
+
+  static bool overflowPending()
+  {
+    return simulatedOverflows(hardwareTime) != servicedOverflows;
+  }
+};
+
+// sets the time, the overflow interrupt is pending up to latency counts after the overflow
+static void simulate(uint64_t time, uint16_t latency, uint32_t random)
+{
+  hardwareTime= time;
+  servicedOverflows= simulatedOverflows(time);
+  if( servicedOverflows > 0 && simulatedOverflows(time - latency) != servicedOverflows && (random & 1) != 0 )
+    --servicedOverflows;
+  SABA::Timing::ticker= uint16_t(servicedOverflows);
+  readAdvance= uint8_t(random >> 1) & 3;
+}
+
+template<class CLOCK> static void testClock(uint16_t top, bool atTop)
+{
+  uint32_t random= 7;
+  uint32_t errors= 0;
+
+  simulatedTop= top;
+  simulatedAtTop= atTop;
+
+  // random times, the timestamp is the time of reading the counter, +1 if the overflow is at TOP
+  for(uint32_t i=0;i < 1000000;i++)
+  {
+    random= random * 1664525 + 1013904223;
+    uint64_t time= (uint64_t(random) << 8) % (uint64_t(0x10000) * CLOCK::PERIOD * 2);
+    if( (i & 1) != 0 )
+      time= time - time % CLOCK::PERIOD + (random & 7) + (atTop ? CLOCK::PERIOD - 5 : 0);
+
+    simulate(time, 40, random >> 16);
+    uint64_t expected= atTop ? time + 1 : time;
+    uint32_t counts= CLOCK::counts();
+
+    if( CLOCK::WRAP == 0 ? counts != uint32_t(expected) : counts % CLOCK::WRAP != expected % CLOCK::WRAP )
+      ++errors;
+  }
+  SABA_EQUAL( errors, 0);
+
+  // every count across several overflows and the wrap around of the ticker, the interrupt is served late
+  uint64_t first= uint64_t(0x10000) * CLOCK::PERIOD - 3 * CLOCK::PERIOD;
+  simulate(first, 0, 0);
+  uint32_t start= CLOCK::counts();
+  for(uint64_t time= first + 1;time < first + 6 * CLOCK::PERIOD;time++)
+  {
+    random= random * 1664525 + 1013904223;
+    simulate(time, 20, random >> 16);
+    if( CLOCK::elapsed(start) != time - first )
+      ++errors;
+  }
+  SABA_EQUAL( errors, 0);
+}
+
+void testTiming_clock()
+{
+  typedef SABA::Timing::Clock<SimulatedCounter,SABA::Timer16::By256,SABA::Timer16::FAST_PWM_ICR1,625> PwmClock;
+  typedef SABA::Timing::Clock<SimulatedCounter,SABA::Timer16::By8,SABA::Timer16::Normal,0xffff> NormalClock;
+  typedef SABA::Timing::Clock<SimulatedCounter,SABA::Timer16::By1,SABA::Timer16::Normal,0xffff> FastClock;
+
+  static_assert(PwmClock::toMicros(625) == 10000, "16 us per count");
+  static_assert(NormalClock::toMicros(2000) == 1000, "0.5 us per count");
+  static_assert(FastClock::toMicros(16) == 1, "1/16 us per count");
+  static_assert(PwmClock::toCycles(1) == 256, "256 cycles per count");
+
+  testClock<PwmClock>(625, true);
+  testClock<NormalClock>(0xffff, false);
+
+  simulate(0, 0, 0);
+  SABA_EQUAL( PwmClock::micros(), 16);
+  SABA_EQUAL( NormalClock::cycles(), 0);
+}
+
+// the simulated Timer1 in Normal mode for the tickless test, the time passes by ticklessAdvance counts after each read
+static uint64_t ticklessTime;
+static uint64_t ticklessServiced;
+static uint16_t compareValue;
+static bool compareFlag;
+static bool compareEnabled;
+static uint8_t ticklessAdvance;
+
+// the time passes with interrupts disabled, the match sets the flag only
+static void ticklessStep(uint32_t counts)
+{
+  for(;counts != 0;counts--)
+    if( uint16_t(++ticklessTime) == compareValue )
+      compareFlag= true;
+}
+
+struct SimulatedCompare
+{
+  static void initialize(SABA::Timer16::ClockSelect clockSelect)
+  {
+  }
+
+  static uint16_t count()
+  {
+    uint16_t value= uint16_t(ticklessTime);
+    ticklessStep(ticklessAdvance);
+
+    return value;
+  }
+
+  static bool overflowPending()
+  {
+    return (ticklessTime >> 16) != ticklessServiced;
+  }
+
+  static void setCompare(uint16_t value)
+  {
+    compareValue= value;
+  }
+
+  static void enableCompare()
+  {
+    compareFlag= false;
+    compareEnabled= true;
+  }
+
+  static void disableCompare()
+  {
+    compareEnabled= false;
+  }
+};
+
+static SABA::Timing::TicklessTimer1<SimulatedCompare,SABA::Timer16::By8> tickless;
+static uint8_t ticklessCallbacks;
+
+static void ticklessCallback(void *env)
+{
+  ++ticklessCallbacks;
+}
+
+// the time passes with interrupts enabled, the compare interrupt has the higher priority
+static void ticklessRun(uint32_t counts)
+{
+  for(;counts != 0;counts--)
+  {
+    ticklessStep(1);
+    if( compareEnabled && compareFlag )
+    {
+      compareFlag= false;
+      tickless.compareMatch();
+    }
+    if( SimulatedCompare::overflowPending() )
+    {
+      ++ticklessServiced;
+      tickless.overflow();
+    }
+  }
+  tickless.cyclic();
+}
+
+void testTiming_tickless()
+{
+  SABA::Timing::TicklessDelay delay;
+
+  // the overflow interrupt is pending, now() counts it
+  ticklessRun(0x1fffe);
+  SABA_EQUAL( tickless.now(), 0x1fffe);
+  ticklessStep(4);
+  SABA_EQUAL( tickless.now(), 0x20002);
+  ticklessRun(1);
+  SABA_EQUAL( tickless.now(), 0x20003);
+  SABA_EQUAL( uint8_t(ticklessServiced), 2);
+
+  // the deadline is in a later overflow period, the overflow interrupt enables the compare
+  tickless.start(delay, 0x18000, nullptr, ticklessCallback);
+  SABA_EQUAL( compareEnabled, false);
+  ticklessRun(0xffff);
+  SABA_EQUAL( compareEnabled, true);
+  ticklessRun(0x8000);
+  SABA_EQUAL( delay.isRunning(), true);
+  SABA_EQUAL( delay(), false);
+  ticklessRun(1);
+  SABA_EQUAL( delay(), true);
+  SABA_EQUAL( ticklessCallbacks, 1);
+  SABA_EQUAL( tickless.now(), 0x38003);
+
+  // the match at 0x3ffff passed and TCNT1 wrapped, before the compare was enabled
+  ticklessRun(0x3fffc - 0x38003);
+  ticklessAdvance= 2;
+  tickless.start(delay, 3);
+  ticklessAdvance= 0;
+  SABA_EQUAL( compareEnabled, false);
+  tickless.cyclic();
+  SABA_EQUAL( delay(), true);
+  SABA_EQUAL( tickless.now(), 0x40002);
+
+  // a deadline in the current period
+  tickless.start(delay, 100);
+  ticklessRun(99);
+  SABA_EQUAL( delay(), false);
+  ticklessRun(1);
+  SABA_EQUAL( delay(), true);
+}
+
+static SABA::Timing::ScheduledCallbackDelay benchmarkTimers[TIMERS];
+static uint32_t benchmarkDone;
+
+static void benchmarkCallback(void *env)
+{
+  ++benchmarkDone;
+  benchmarkTimers[uintptr_t(env)].start(1000, env, benchmarkCallback);
+}
+
+void testTiming_time()
+{
+  SABA::Timing::Deadline deadline;
+  SABA::Timing::SingleDelay<uint32_t> longDelay;
+  SABA::Timing::SingleDelay<uint16_t> shortDelay;
+
+  SABA::Timing::ticker= 0xfff0;
+  uint32_t start= SABA::Timing::now();
+  SABA_EQUAL( uint16_t(start), 0xfff0);
+
+  deadline.set(100000);
+  longDelay.start(100000);
+  shortDelay.start(0x20);
+
+  // the epoch is counted by now(), called at least once per 65536 ticks
+  uint32_t errors= 0;
+  for(uint32_t i=1;i < 100000;i++)
+  {
+    ++SABA::Timing::ticker;
+    if( SABA::Timing::elapsed(start) != i || deadline.expired() || longDelay() )
+      ++errors;
+    if( deadline.remaining() != 100000 - i )
+      ++errors;
+    if( shortDelay() != (i == 0x20) )
+      ++errors;
+  }
+  SABA_EQUAL( errors, 0);
+
+  ++SABA::Timing::ticker;
+  SABA_EQUAL( SABA::Timing::elapsed(start), 100000);
+  SABA_EQUAL( deadline.expired(), true);
+  SABA_EQUAL( deadline.remaining(), 0);
+  SABA_EQUAL( longDelay(), true);
+  SABA_EQUAL( longDelay(), false);
+
+  // the 16 bit snapshot of a uint8_t delay
+  SABA::Timing::SingleDelay<uint8_t> byteDelay;
+  SABA::Timing::ticker= 0xfffe;
+  byteDelay.start(3);
+  SABA::Timing::ticker += 2;
+  SABA_EQUAL( byteDelay(), false);
+  ++SABA::Timing::ticker;
+  SABA_EQUAL( byteDelay(), true);
+}
+
+void benchmarkTiming()
+{
+  static constexpr uint32_t COUNT = 100000;
+  SABA::Timing::SingleDelay<uint16_t> polled[TIMERS];
+  uint32_t done= 0;
+
+  benchmarkDone= 0;
+  for(uint8_t t=0;t < TIMERS;t++)
+    polled[t].start(uint16_t(1000 + t * 10));
+
+  auto start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    ++SABA::Timing::ticker;
+    for(uint8_t t=0;t < TIMERS;t++)
+    {
+      if( polled[t]() )
+      {
+        ++done;
+        polled[t].start(1000);
+      }
+    }
+  }
+  auto polling= std::chrono::steady_clock::now() - start;
+
+  // the scheduler is synchronized to the ticker, the previous tests moved it
+  SABA::Timing::scheduler.cyclic();
+  for(uint8_t t=0;t < TIMERS;t++)
+    benchmarkTimers[t].start(uint16_t(1000 + t * 10), (void *)uintptr_t(t), benchmarkCallback);
+
+  start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    ++SABA::Timing::ticker;
+    SABA::Timing::scheduler.cyclic();
+  }
+  auto scheduler= std::chrono::steady_clock::now() - start;
+
+  for(uint8_t t=0;t < TIMERS;t++)
+    benchmarkTimers[t].stop();
+
+  SABA_EQUAL( done, benchmarkDone);
+
+  out << SABA::dec << PSTR("  32 timers per tick, polled: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(polling).count() / COUNT)
+    << PSTR(" ns, scheduled: ")
+    << uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(scheduler).count() / COUNT)
+    << PSTR(" ns") << SABA::endl;
+}
+
+void testTiming()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Timing Tests") << SABA::endl;
+
+  testTiming_order();
+  testTiming_late();
+  testTiming_scope();
+  testTiming_restart();
+  testTiming_long();
+  testTiming_compare();
+  testTiming_time();
+  testTiming_tickless();
+  testTiming_clock();
+  benchmarkTiming();
+
+  out << SABA::dec << PSTR("  Timing Tests Finished") << SABA::endl;
+}
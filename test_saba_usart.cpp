@@ -0,0 +1,267 @@
+/*
+ * test_saba_usart.cpp
+ *
+ * Created: 17.10.2026
+ *  Author: Joerg
+ *
+ * Host test, the Usart registers are replaced by a stub class,
+ * the blocking test needs a thread library
+ */
+
+#include <thread>
+#include <chrono>
+
+#include "saba_pstr.h"
+
+#include <saba_test.h>
+
+#include "saba_usart.h"
+
+// replaces the Usart register access, the interrupt enable bits are just flags
+class UsartStub
+{
+public:
+
+  UsartStub(uint32_t baudrate)
+  {
+  }
+
+  void writeData( uint8_t ch )
+  {
+    wire[wireCount++ & 0xff]= ch;
+  }
+
+  uint8_t readData()
+  {
+    return rxData;
+  }
+
+  void enableReceiveInterrupt( bool enable )
+  {
+    rxcie= enable;
+  }
+
+  void enableDataRegisterEmptyInterrupt( bool enable )
+  {
+    udrie= enable;
+  }
+
+  uint8_t wire[256];
+  volatile uint32_t wireCount = 0;
+  uint8_t rxData = 0;
+  bool rxcie = false;
+  volatile bool udrie = false;
+};
+
+template<class BUFFERED_USART> void sendAll(BUFFERED_USART& usart)
+{
+  while( usart.udrie )
+    usart.dataRegisterEmptyInterrupt();
+}
+
+void testBufferedUsart_transmit()
+{
+  SABA::BufferedUsart<UsartStub,8,16,SABA::OverflowDrop> usart(57600);
+
+  SABA_EQUAL( usart.rxcie, true);
+  SABA_EQUAL( usart.udrie, false);
+
+  for(uint8_t i=0;i < 10;i++)
+    SABA_EQUAL( usart.putch('a' + i), true);
+  SABA_EQUAL( usart.udrie, true);
+
+  sendAll(usart);
+  SABA_EQUAL( usart.udrie, false);
+  SABA_EQUAL( usart.wireCount, 10);
+  for(uint8_t i=0;i < 10;i++)
+    SABA_EQUAL( usart.wire[i], 'a' + i);
+}
+
+void testBufferedUsart_drop()
+{
+  SABA::BufferedUsart<UsartStub,8,16,SABA::OverflowDrop> usart(57600);
+
+  for(uint8_t i=0;i < 16;i++)
+    SABA_EQUAL( usart.putch(i), true);
+  SABA_EQUAL( usart.putch(16), false);
+  SABA_EQUAL( usart.putch(17), false);
+  SABA_EQUAL( usart.transmitOverflows(), 2);
+
+  sendAll(usart);
+  SABA_EQUAL( usart.wireCount, 16);
+  SABA_EQUAL( usart.wire[0], 0);
+  SABA_EQUAL( usart.wire[15], 15);
+}
+
+void testBufferedUsart_write()
+{
+  SABA::BufferedUsart<UsartStub,8,16,SABA::OverflowDrop> usart(57600);
+  const uint8_t data[10]= { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+  SABA_EQUAL( usart.write(data, 10), 10);
+  SABA_EQUAL( usart.udrie, true);
+  SABA_EQUAL( usart.write(data, 10), 6);
+  SABA_EQUAL( usart.transmitOverflows(), 4);
+
+  sendAll(usart);
+  SABA_EQUAL( usart.wireCount, 16);
+  SABA_EQUAL( usart.wire[9], 9);
+  SABA_EQUAL( usart.wire[15], 5);
+}
+
+void testBufferedUsart_writeBlock()
+{
+  SABA::BufferedUsart<UsartStub,8,16> usart(57600);
+  static constexpr uint8_t LENGTH = 40;
+  uint8_t data[LENGTH];
+  volatile bool done= false;
+
+  for(uint8_t i=0;i < LENGTH;i++)
+    data[i]= i;
+
+  // the thread simulates the data register empty interrupt, it runs only, if write enabled it
+  std::thread isr([&usart,&done]()
+  {
+    while( !done || usart.udrie )
+    {
+      if( usart.udrie )
+        usart.dataRegisterEmptyInterrupt();
+      else
+        std::this_thread::yield();
+    }
+  });
+
+  // longer than the buffer, putch blocks until the interrupt made space
+  SABA_EQUAL( usart.write(data, LENGTH), LENGTH);
+  usart.flush();
+  done= true;
+  isr.join();
+
+  SABA_EQUAL( usart.wireCount, LENGTH);
+  SABA_EQUAL( usart.transmitOverflows(), 0);
+  for(uint8_t i=0;i < LENGTH;i++)
+    SABA_EQUAL( usart.wire[i], i);
+}
+
+void testBufferedUsart_overwrite()
+{
+  SABA::BufferedUsart<UsartStub,8,16,SABA::OverflowOverwrite> usart(57600);
+
+  for(uint8_t i=0;i < 20;i++)
+    SABA_EQUAL( usart.putch(i), true);
+  SABA_EQUAL( usart.transmitOverflows(), 4);
+
+  // the oldest bytes are lost, the newest are sent
+  sendAll(usart);
+  SABA_EQUAL( usart.wireCount, 16);
+  SABA_EQUAL( usart.wire[0], 4);
+  SABA_EQUAL( usart.wire[15], 19);
+}
+
+void testBufferedUsart_receive()
+{
+  SABA::BufferedUsart<UsartStub,8,16> usart(57600);
+
+  SABA_EQUAL( usart.available(), 0);
+  SABA_EQUAL( usart.receiverComplete(), false);
+
+  for(uint8_t i=0;i < 10;i++)
+  {
+    usart.rxData= '0' + i;
+    usart.receiveInterrupt();
+  }
+  SABA_EQUAL( usart.available(), 8);
+  SABA_EQUAL( usart.receiveOverflows(), 2);
+  SABA_EQUAL( usart.receiverComplete(), true);
+
+  for(uint8_t i=0;i < 8;i++)
+    SABA_EQUAL( usart.read(), '0' + i);
+  SABA_EQUAL( usart.available(), 0);
+  SABA_EQUAL( usart.read(), 0);
+}
+
+void testBufferedUsart_block()
+{
+  static constexpr uint32_t COUNT = 20000;
+  SABA::BufferedUsart<UsartStub,8,32> usart(57600);
+  uint32_t errors= 0;
+  volatile bool done= false;
+
+  // the thread simulates the data register empty interrupt
+  std::thread isr([&usart,&done]()
+  {
+    while( !done || usart.udrie )
+    {
+      if( usart.udrie )
+        usart.dataRegisterEmptyInterrupt();
+      else
+        std::this_thread::yield();
+    }
+  });
+
+  auto start= std::chrono::steady_clock::now();
+  for(uint32_t i=0;i < COUNT;i++)
+  {
+    usart.putch(uint8_t(i));
+    if( usart.wireCount > 0 && usart.wire[(usart.wireCount - 1) & 0xff] != uint8_t(usart.wireCount - 1) )
+      ++errors;
+  }
+  usart.flush();
+  done= true;
+  isr.join();
+  auto duration= std::chrono::steady_clock::now() - start;
+
+  SABA_EQUAL( usart.wireCount, COUNT);
+  SABA_EQUAL( usart.transmitOverflows(), 0);
+  SABA_EQUAL( errors, 0);
+
+  out << SABA::dec << PSTR("  BufferedUsart: ")
+    << uint32_t(COUNT * 1000 / (1 + std::chrono::duration_cast<std::chrono::microseconds>(duration).count()))
+    << PSTR(" kbyte/s") << SABA::endl;
+}
+
+void testUsartBaud()
+{
+  typedef SABA::UsartBaud<57600,25,16000000> Baud57600;
+  typedef SABA::UsartBaud<115200,25,16000000> Baud115200;
+  typedef SABA::UsartBaud<250000,25,16000000> Baud250000;
+  typedef SABA::UsartBaud<1000000,25,16000000> Baud1M;
+  typedef SABA::UsartBaud<9600,25,8000000> Baud9600;
+
+  SABA_EQUAL( Baud57600::U2X, true);
+  SABA_EQUAL( Baud57600::UBRR, 34);
+  SABA_EQUAL( Baud57600::ERROR_PERMILLE, 7);
+
+  SABA_EQUAL( Baud115200::U2X, true);
+  SABA_EQUAL( Baud115200::UBRR, 16);
+  SABA_EQUAL( Baud115200::ERROR_PERMILLE, 21);
+
+  // exact without double speed
+  SABA_EQUAL( Baud250000::U2X, false);
+  SABA_EQUAL( Baud250000::UBRR, 3);
+  SABA_EQUAL( Baud250000::ERROR_PERMILLE, 0);
+
+  SABA_EQUAL( Baud1M::U2X, false);
+  SABA_EQUAL( Baud1M::UBRR, 0);
+
+  SABA_EQUAL( Baud9600::U2X, false);
+  SABA_EQUAL( Baud9600::UBRR, 51);
+  SABA_EQUAL( Baud9600::ERROR_PERMILLE, 1);
+}
+
+void testUsart()
+{
+  out.width(0);
+  out << SABA::dec << PSTR("  Starting Usart Tests") << SABA::endl;
+
+  testBufferedUsart_transmit();
+  testBufferedUsart_drop();
+  testBufferedUsart_write();
+  testBufferedUsart_writeBlock();
+  testBufferedUsart_overwrite();
+  testBufferedUsart_receive();
+  testBufferedUsart_block();
+  testUsartBaud();
+
+  out << SABA::dec << PSTR("  Usart Tests Finished") << SABA::endl;
+}
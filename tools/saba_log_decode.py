@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+#
+# saba_log_decode.py
+#
+# Saarbastler AVR C++ 11 Library
+#
+# Created: 17.10.2026
+# Author: Joerg
+#
+# Decodes the binary records of SABA::DeferredLog. The format strings are read from the FLASH image in the ELF
+# file, the record ID is the address of the SABA_LOG table entry.
+#
+# Usage:
+#   saba_log_decode.py firmware.elf capture.bin
+#   saba_log_decode.py firmware.elf /dev/ttyUSB0 57600     (needs pyserial)
+
+import re
+import struct
+import sys
+
+SHF_ALLOC = 2
+SHT_PROGBITS = 1
+
+
+class Elf:
+  """the allocated sections of a little endian ELF file"""
+
+  def __init__(self, path):
+    with open(path, 'rb') as f:
+      data = f.read()
+
+    if data[:4] != b'\x7fELF' or data[5] != 1:
+      raise ValueError('%s is not a little endian ELF file' % path)
+
+    if data[4] == 1:
+      shoff, = struct.unpack_from('<I', data, 0x20)
+      shentsize, shnum = struct.unpack_from('<HH', data, 0x2e)
+      header = '<IIIIII'
+    else:
+      shoff, = struct.unpack_from('<Q', data, 0x28)
+      shentsize, shnum = struct.unpack_from('<HH', data, 0x3a)
+      header = '<IIQQQQ'
+
+    self.sections = []
+    for i in range(shnum):
+      name, kind, flags, addr, offset, size = struct.unpack_from(header, data, shoff + i * shentsize)
+      if kind == SHT_PROGBITS and flags & SHF_ALLOC:
+        self.sections.append((addr, data[offset:offset + size]))
+
+  def string(self, address):
+    """the 0 terminated string at address, None if the address is not in an allocated section"""
+    for addr, content in self.sections:
+      if addr <= address < addr + len(content):
+        start = address - addr
+        end = content.find(b'\0', start)
+        if end >= 0:
+          return content[start:end].decode('latin-1')
+    return None
+
+
+class Decoder:
+  """converts the record byte stream to text"""
+
+  PLACEHOLDER = re.compile(r'\{(?::(.))?\}')
+  CODES = re.compile(r'[BbHhIic?]*$')
+
+  def __init__(self, elf):
+    self.elf = elf
+    self.entries = {}
+    self.buffer = bytearray()
+    self.skipped = 0
+
+  def entry(self, id):
+    if id not in self.entries:
+      fmt = self.elf.string(id)
+      codes = self.elf.string(id + len(fmt) + 1) if fmt is not None else None
+      # an address inside another string or code is not a valid entry
+      if not fmt or codes is None or not self.CODES.match(codes) or len(self.PLACEHOLDER.findall(fmt)) != len(codes):
+        codes = None
+      self.entries[id] = (fmt, codes) if codes is not None else None
+    return self.entries[id]
+
+  @staticmethod
+  def value(spec, code, value):
+    if code == '?':
+      return 'true' if value else 'false'
+    if code == 'c' or spec == 'c':
+      return value.decode('latin-1') if isinstance(value, bytes) else chr(value)
+    if spec == 'x':
+      size = struct.calcsize(code)
+      return '%0*X' % (size * 2, value & ((1 << (size * 8)) - 1))
+    return str(value)
+
+  def feed(self, data):
+    """appends received bytes, returns the decoded lines"""
+    self.buffer += data
+    lines = []
+    while len(self.buffer) >= 2:
+      id, = struct.unpack_from('<H', self.buffer)
+      entry = self.entry(id)
+      if entry is None:
+        # not a record start, synchronize on the next byte
+        self.skipped += 1
+        del self.buffer[0]
+        continue
+
+      if self.skipped:
+        lines.append('<%d bytes skipped>' % self.skipped)
+        self.skipped = 0
+
+      fmt, codes = entry
+      size = struct.calcsize('<' + codes)
+      if len(self.buffer) < 2 + size:
+        break
+
+      values = iter(zip(codes, struct.unpack_from('<' + codes, self.buffer, 2)))
+      del self.buffer[:2 + size]
+      lines.append(self.PLACEHOLDER.sub(lambda m: self.value(m.group(1), *next(values)), fmt))
+    return lines
+
+
+def main(argv):
+  if len(argv) < 3:
+    print('usage: %s firmware.elf capture|- [baudrate]' % argv[0], file=sys.stderr)
+    return 1
+
+  decoder = Decoder(Elf(argv[1]))
+
+  if len(argv) > 3:
+    import serial
+    port = serial.Serial(argv[2], int(argv[3]))
+    read = lambda: port.read(max(1, port.in_waiting))
+  elif argv[2] == '-':
+    read = lambda: sys.stdin.buffer.read1(256)
+  else:
+    stream = open(argv[2], 'rb')
+    read = lambda: stream.read(256)
+
+  while True:
+    data = read()
+    if not data:
+      return 0
+    for line in decoder.feed(data):
+      print(line, end='' if line.endswith('\n') else '\n', flush=True)
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+#
+# saba_monitor_snapshot.py
+#
+# Saarbastler AVR C++ 11 Library
+#
+# Created: 17.10.2026
+# Author: Joerg
+#
+# Reads a memory block with the "block" command of SABA::Monitor and writes it to a binary file. The default is the
+# SRAM of an ATmega328P, 0x100 - 0x8ff. 2 KB take about 0.4 s at 57600 Baud.
+# Reading some I/O registers has side effects, e.g. UDR0 or the flags cleared by reading, keep them out of the range.
+#
+# Usage:
+#   saba_monitor_snapshot.py /dev/ttyUSB0 57600 sram.bin
+#   saba_monitor_snapshot.py /dev/ttyUSB0 57600 flash.bin f 0 8000     (needs pyserial)
+
+import sys
+import time
+
+
+def snapshot(port, space, address, count, timeout):
+  """sends the block command and returns the count raw bytes following the echoed command line"""
+  command = 'block %s %x %x' % (space, address, count)
+  port.reset_input_buffer()
+  port.write((command + '\r').encode('ascii'))
+
+  # the command line is echoed, followed by CR LF
+  echo = b''
+  deadline = time.time() + timeout
+  while not echo.endswith(b'\r\n'):
+    ch = port.read(1)
+    if not ch:
+      if time.time() > deadline:
+        raise IOError('no echo of "%s"' % command)
+      continue
+    echo += ch
+
+  data = b''
+  while len(data) < count:
+    chunk = port.read(count - len(data))
+    if not chunk:
+      if time.time() > deadline:
+        raise IOError('%d of %d bytes received' % (len(data), count))
+      continue
+    data += chunk
+    deadline = time.time() + timeout
+
+  return data
+
+
+def main(argv):
+  if len(argv) not in (4, 7):
+    sys.stderr.write('usage: %s port baud file [d|f address count]\n' % argv[0])
+    return 1
+
+  space, address, count = 'd', 0x100, 0x800
+  if len(argv) == 7:
+    space, address, count = argv[4], int(argv[5], 16), int(argv[6], 16)
+
+  import serial
+  with serial.Serial(argv[1], int(argv[2]), timeout=0.1) as port:
+    data = snapshot(port, space, address, count, 2.0)
+
+  with open(argv[3], 'wb') as f:
+    f.write(data)
+
+  print('%d bytes %s:%04x written to %s' % (len(data), space, address, argv[3]))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv))